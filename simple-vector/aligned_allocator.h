@@ -0,0 +1,272 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_set>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// Размер строки кэша, до которого по умолчанию выравнивается память
+inline constexpr size_t kCacheLineSize = 64;
+// Размер большой страницы x86-64 и AArch64
+inline constexpr size_t kHugePageSize = size_t{2} << 20;
+// Размер обычной страницы памяти, с которым касаются памяти PrefaultPages
+inline constexpr size_t kPageSize = 4096;
+// Порог AlignedAllocator, отключающий выделение памяти на больших страницах
+inline constexpr size_t kNoHugePages = 0;
+
+// Записывает по байту в каждую страницу, в которую попадает блок
+// [block, block + bytes), чтобы система отобразила их сейчас, а не при первой
+// записи элемента. Блок может начинаться не с границы страницы: в первой странице
+// записывается первый байт блока, в остальных — байт на границе страницы.
+// Блок должен быть неинициализированной памятью: его содержимое затирается
+inline void PrefaultPages(void* block, size_t bytes) noexcept {
+    if (bytes == 0) {
+        return;
+    }
+    volatile unsigned char* const begin = static_cast<unsigned char*>(block);
+    begin[0] = 0;
+    const size_t first_boundary = kPageSize - reinterpret_cast<uintptr_t>(block) % kPageSize;
+    for (size_t offset = first_boundary; offset < bytes; offset += kPageSize) {
+        begin[offset] = 0;
+    }
+}
+
+// Помнит блоки, для которых система приняла запрос на большие страницы.
+// Такие блоки крупнее kHugePageSize, поэтому их немного и мьютекс не мешает
+class HugePageRegistry {
+public:
+    static void Add(const void* block) {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        registry.blocks.insert(block);
+    }
+
+    static void Remove(const void* block) noexcept {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        registry.blocks.erase(block);
+    }
+
+    static bool Contains(const void* block) noexcept {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        return registry.blocks.count(block) != 0;
+    }
+
+private:
+    struct Registry {
+        std::mutex mutex;
+        std::unordered_set<const void*> blocks;
+    };
+
+    static Registry& GetRegistry() noexcept {
+        static Registry registry;
+        return registry;
+    }
+};
+
+// Аллокатор, выравнивающий память по Alignment байт (по умолчанию по строке кэша),
+// чтобы SIMD-загрузки из буфера вектора были выровненными.
+// Блоки от HugePageThreshold байт выделяются через mmap с выравниванием по 2 МиБ
+// и madvise(MADV_HUGEPAGE), чтобы ядро отобразило их прозрачными большими страницами
+// и при обходе было меньше промахов TLB. С ExplicitHugePages сначала запрашиваются
+// страницы из пула hugetlbfs (MAP_HUGETLB); если пул пуст или не настроен, память
+// выделяется как обычно. Если madvise не поддерживается, блок остаётся на обычных
+// страницах. Вне Linux большие блоки выделяются так же, как маленькие
+template <typename Type, size_t Alignment = kCacheLineSize, size_t HugePageThreshold = kHugePageSize,
+          bool ExplicitHugePages = false>
+class AlignedAllocator {
+    static_assert(Alignment > 0 && (Alignment & (Alignment - 1)) == 0, "alignment must be a power of two");
+    static_assert(Alignment >= alignof(Type), "alignment must not be weaker than alignof(Type)");
+    static_assert(HugePageThreshold == kNoHugePages || Alignment <= kHugePageSize,
+                  "huge page blocks are aligned to kHugePageSize only");
+
+public:
+    using value_type = Type;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    template <typename Other>
+    struct rebind {
+        using other = AlignedAllocator<Other, std::max(Alignment, alignof(Other)), HugePageThreshold, ExplicitHugePages>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename Other, size_t OtherAlignment>
+    AlignedAllocator(const AlignedAllocator<Other, OtherAlignment, HugePageThreshold, ExplicitHugePages>& /*other*/) noexcept {
+    }
+
+    // Возвращает выравнивание, которое аллокатор гарантирует для каждого блока
+    static constexpr size_t GetAlignment() noexcept {
+        return Alignment;
+    }
+
+    [[nodiscard]] Type* allocate(size_t count) {
+        if (count > std::numeric_limits<size_t>::max() / sizeof(Type)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = count * sizeof(Type);
+        if (UsesHugePages(bytes)) {
+            return static_cast<Type*>(MapHugePages(bytes));
+        }
+        return static_cast<Type*>(::operator new(bytes, std::align_val_t{Alignment}));
+    }
+
+    void deallocate(Type* ptr, size_t count) noexcept {
+        const size_t bytes = count * sizeof(Type);
+        if (UsesHugePages(bytes)) {
+            UnmapHugePages(ptr, bytes);
+            return;
+        }
+        ::operator delete(ptr, std::align_val_t{Alignment});
+    }
+
+    // Меняет размер блока на больших страницах на месте вызовом mremap без
+    // MREMAP_MAYMOVE, так что выравнивание и большие страницы сохраняются.
+    // Возвращает nullptr, если блок маленький или за ним нет свободного места
+    [[nodiscard]] Type* reallocate(Type* ptr, size_t old_count, size_t new_count) noexcept {
+        if (new_count > std::numeric_limits<size_t>::max() / sizeof(Type)) {
+            return nullptr;
+        }
+        const size_t old_bytes = old_count * sizeof(Type);
+        const size_t new_bytes = new_count * sizeof(Type);
+        if (!UsesHugePages(old_bytes) || !UsesHugePages(new_bytes) || RoundUpToHugePage(new_bytes) < new_bytes) {
+            return nullptr;
+        }
+        return RemapHugePages(ptr, old_bytes, new_bytes) ? ptr : nullptr;
+    }
+
+    // Сообщает, приняла ли система запрос на большие страницы для блока ptr
+    // из count элементов, выделенного этим аллокатором
+    static bool IsHugePageBacked(const Type* ptr, size_t count) noexcept {
+        return UsesHugePages(count * sizeof(Type)) && HugePageRegistry::Contains(ptr);
+    }
+
+private:
+    static constexpr bool UsesHugePages(size_t bytes) noexcept {
+#if defined(__linux__)
+        return HugePageThreshold != kNoHugePages && bytes >= HugePageThreshold;
+#else
+        static_cast<void>(bytes);
+        return false;
+#endif
+    }
+
+    static constexpr size_t RoundUpToHugePage(size_t bytes) noexcept {
+        return (bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    }
+
+#if defined(__linux__)
+    static void* MapHugePages(size_t bytes) {
+        const size_t mapped = RoundUpToHugePage(bytes);
+        if (mapped < bytes) {
+            throw std::bad_alloc();
+        }
+        constexpr int kProtection = PROT_READ | PROT_WRITE;
+        constexpr int kFlags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_HUGETLB
+        if constexpr (ExplicitHugePages) {
+            void* block = ::mmap(nullptr, mapped, kProtection, kFlags | MAP_HUGETLB, -1, 0);
+            if (block != MAP_FAILED) {
+                RegisterHugePages(block);
+                return block;
+            }
+        }
+#endif
+        // Отображение с запасом в одну большую страницу, чтобы выровнять начало
+        // по 2 МиБ; лишнее по краям сразу возвращается системе
+        void* raw = ::mmap(nullptr, mapped + kHugePageSize, kProtection, kFlags, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        const uintptr_t raw_begin = reinterpret_cast<uintptr_t>(raw);
+        const uintptr_t begin = (raw_begin + kHugePageSize - 1) & ~(uintptr_t{kHugePageSize} - 1);
+        if (begin != raw_begin) {
+            ::munmap(raw, begin - raw_begin);
+        }
+        const size_t tail = raw_begin + mapped + kHugePageSize - (begin + mapped);
+        if (tail != 0) {
+            ::munmap(reinterpret_cast<void*>(begin + mapped), tail);
+        }
+        void* block = reinterpret_cast<void*>(begin);
+#ifdef MADV_HUGEPAGE
+        if (::madvise(block, mapped, MADV_HUGEPAGE) == 0) {
+            RegisterHugePages(block);
+        }
+#endif
+        return block;
+    }
+
+    // Большие страницы — лишь оптимизация: если запомнить блок не удалось,
+    // он просто не будет отмечен в диагностике
+    static void RegisterHugePages(const void* block) noexcept {
+        try {
+            HugePageRegistry::Add(block);
+        } catch (...) {
+        }
+    }
+
+    static void UnmapHugePages(void* block, size_t bytes) noexcept {
+        HugePageRegistry::Remove(block);
+        ::munmap(block, RoundUpToHugePage(bytes));
+    }
+
+    static bool RemapHugePages(void* block, size_t old_bytes, size_t new_bytes) noexcept {
+        const size_t old_mapped = RoundUpToHugePage(old_bytes);
+        const size_t new_mapped = RoundUpToHugePage(new_bytes);
+        return old_mapped == new_mapped || ::mremap(block, old_mapped, new_mapped, 0) != MAP_FAILED;
+    }
+#else
+    static void* MapHugePages(size_t /*bytes*/) {
+        throw std::bad_alloc();
+    }
+
+    static void UnmapHugePages(void* /*block*/, size_t /*bytes*/) noexcept {
+    }
+
+    static bool RemapHugePages(void* /*block*/, size_t /*old_bytes*/, size_t /*new_bytes*/) noexcept {
+        return false;
+    }
+#endif
+};
+
+template <typename Lhs, size_t LhsAlignment, typename Rhs, size_t RhsAlignment, size_t Threshold, bool Explicit>
+bool operator==(const AlignedAllocator<Lhs, LhsAlignment, Threshold, Explicit>&,
+                const AlignedAllocator<Rhs, RhsAlignment, Threshold, Explicit>&) noexcept {
+    return true;
+}
+
+template <typename Lhs, size_t LhsAlignment, typename Rhs, size_t RhsAlignment, size_t Threshold, bool Explicit>
+bool operator!=(const AlignedAllocator<Lhs, LhsAlignment, Threshold, Explicit>&,
+                const AlignedAllocator<Rhs, RhsAlignment, Threshold, Explicit>&) noexcept {
+    return false;
+}
+
+// Определяет, сообщает ли аллокатор гарантированное выравнивание блоков
+template <typename Allocator, typename = void>
+struct HasAllocationAlignment : std::false_type {
+};
+
+template <typename Allocator>
+struct HasAllocationAlignment<Allocator, std::void_t<decltype(Allocator::GetAlignment())>> : std::true_type {
+};
+
+// Определяет, может ли аллокатор сообщить, выделен ли блок на больших страницах
+template <typename Allocator, typename = void>
+struct HasHugePageQuery : std::false_type {
+};
+
+template <typename Allocator>
+struct HasHugePageQuery<Allocator, std::void_t<decltype(Allocator::IsHugePageBacked(
+                                       std::declval<const typename Allocator::value_type*>(), size_t{}))>>
+    : std::true_type {
+};
@@ -0,0 +1,139 @@
+// Заменяет глобальные operator new и operator delete, чтобы они учитывали
+// выделения в AllocationCounter. Заменяющие функции не могут быть inline,
+// поэтому они определены здесь, а файл компонуется в программу один раз
+
+#include "allocation_counter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Счётчики инициализируются константами до любого выделения памяти и
+// тривиально разрушаемы, поэтому ими можно пользоваться и до, и после main
+static std::atomic<size_t> allocations{0};
+static std::atomic<size_t> allocated_bytes{0};
+
+AllocationStats AllocationCounter::Get() noexcept {
+    return {allocations.load(std::memory_order_relaxed), allocated_bytes.load(std::memory_order_relaxed)};
+}
+
+void AllocationCounter::Record(size_t bytes) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+// Выделяет память для заменённых operator new и учитывает выделение
+static void* CountedAllocate(size_t bytes) {
+    AllocationCounter::Record(bytes);
+    if (void* block = std::malloc(bytes == 0 ? 1 : bytes)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+static void* CountedAllocateAligned(size_t bytes, std::align_val_t alignment) {
+    AllocationCounter::Record(bytes);
+    void* block = nullptr;
+    const size_t align = std::max(static_cast<size_t>(alignment), sizeof(void*));
+    if (::posix_memalign(&block, align, bytes == 0 ? 1 : bytes) != 0) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void* operator new(size_t bytes) {
+    return CountedAllocate(bytes);
+}
+
+void* operator new[](size_t bytes) {
+    return CountedAllocate(bytes);
+}
+
+void* operator new(size_t bytes, std::align_val_t alignment) {
+    return CountedAllocateAligned(bytes, alignment);
+}
+
+void* operator new[](size_t bytes, std::align_val_t alignment) {
+    return CountedAllocateAligned(bytes, alignment);
+}
+
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept {
+    try {
+        return CountedAllocate(bytes);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t bytes, const std::nothrow_t&) noexcept {
+    try {
+        return CountedAllocate(bytes);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(size_t bytes, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return CountedAllocateAligned(bytes, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t bytes, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return CountedAllocateAligned(bytes, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block, size_t) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::align_val_t) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block, std::align_val_t) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, size_t, std::align_val_t) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block, size_t, std::align_val_t) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, const std::nothrow_t&) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block, const std::nothrow_t&) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(block);
+}
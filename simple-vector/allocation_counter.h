@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+// Счётчики выделений памяти через глобальные operator new и operator delete.
+// Так тесты могут проверять, что операция выделяет память ровно столько раз,
+// сколько нужно: например, что копирование вектора выделяет память один раз,
+// а перемещение — ни разу. Сами operator new и operator delete подменяет
+// allocation_counter.cpp, который нужно скомпоновать с программой
+
+// Сколько раз и сколько байт выделено через operator new
+struct AllocationStats {
+    size_t allocations = 0;
+    size_t bytes = 0;
+};
+
+// Определения вместе с заменёнными operator new в allocation_counter.cpp,
+// поэтому программа без него или с двумя его копиями не скомпонуется
+class AllocationCounter {
+public:
+    static AllocationStats Get() noexcept;
+    static void Record(size_t bytes) noexcept;
+};
+
+// Считает выделения всех потоков с момента создания объекта
+class AllocationScope {
+public:
+    AllocationScope() noexcept
+        : start_(AllocationCounter::Get()) {
+    }
+
+    size_t GetAllocations() const noexcept {
+        return AllocationCounter::Get().allocations - start_.allocations;
+    }
+
+    size_t GetBytes() const noexcept {
+        return AllocationCounter::Get().bytes - start_.bytes;
+    }
+
+private:
+    AllocationStats start_;
+};
@@ -1,77 +1,179 @@
+#pragma once
+
 #include <cassert>
 #include <cstdlib>
+#include <memory>
+#include <type_traits>
 #include <utility>
 
-template <typename Type>
+#include "constexpr_support.h"
+
+// Определяет, умеет ли аллокатор менять размер блока методом
+//     Type* reallocate(Type* ptr, size_t old_count, size_t new_count) noexcept;
+// который сохраняет байты блока (возможно, перенося его) и возвращает nullptr,
+// если размер изменить не удалось (см. ReallocAllocator)
+template <typename Allocator, typename = void>
+struct HasReallocate : std::false_type {
+};
+
+template <typename Allocator>
+struct HasReallocate<Allocator, std::void_t<decltype(std::declval<Allocator&>().reallocate(
+                                    std::declval<typename Allocator::value_type*>(), size_t{}, size_t{}))>>
+    : std::true_type {
+};
+
+// RAII-обёртка над неинициализированной памятью в куче.
+// ArrayPtr только выделяет и освобождает память под size элементов типа Type
+// через аллокатор Allocator, но не создаёт и не разрушает сами объекты —
+// этим управляет владелец ArrayPtr
+template <typename Type, typename Allocator = std::allocator<Type>>
 class ArrayPtr {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    static_assert(std::is_same_v<typename AllocTraits::value_type, Type>,
+                  "Allocator::value_type must be the same as Type");
+    static_assert(std::is_same_v<typename AllocTraits::pointer, Type*>,
+                  "fancy pointers are not supported");
+
 public:
     // Инициализирует ArrayPtr нулевым указателем
     ArrayPtr() = default;
 
-    // Создаёт в куче массив из size элементов типа Type.
+    SIMPLE_VECTOR_CONSTEXPR explicit ArrayPtr(const Allocator& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    // Выделяет в куче неинициализированную память под size элементов типа Type.
     // Если size == 0, поле raw_ptr_ должно быть равно nullptr
-    explicit ArrayPtr(size_t size)
-        : raw_ptr_(size == 0 ? nullptr : new Type[size]) {
+    SIMPLE_VECTOR_CONSTEXPR explicit ArrayPtr(size_t size, const Allocator& alloc = Allocator())
+        : alloc_(alloc)
+        , raw_ptr_(size == 0 ? nullptr : AllocTraits::allocate(alloc_, size))
+        , size_(size) {
     }
 
-    // Конструктор из сырого указателя, хранящего адрес массива в куче либо nullptr
-    explicit ArrayPtr(Type* raw_ptr) noexcept 
-        :raw_ptr_(raw_ptr) {
+    // Конструктор из сырого указателя на память под size элементов,
+    // выделенную аллокатором alloc, либо nullptr
+    SIMPLE_VECTOR_CONSTEXPR ArrayPtr(Type* raw_ptr, size_t size, const Allocator& alloc = Allocator()) noexcept
+        : alloc_(alloc)
+        , raw_ptr_(raw_ptr)
+        , size_(raw_ptr == nullptr ? 0 : size) {
     }
 
     // Запрещаем копирование
     ArrayPtr(const ArrayPtr&) = delete;
 
-    ~ArrayPtr() {
-        delete[] raw_ptr_;
+    SIMPLE_VECTOR_CONSTEXPR ~ArrayPtr() {
+        Deallocate();
     }
 
     // Запрещаем присваивание
     ArrayPtr& operator=(const ArrayPtr&) = delete;
 
-    ArrayPtr(ArrayPtr&& other) {
-        raw_ptr_ = std::exchange(other.raw_ptr_, nullptr);
+    SIMPLE_VECTOR_CONSTEXPR ArrayPtr(ArrayPtr&& other) noexcept
+        : alloc_(std::move(other.alloc_))
+        , raw_ptr_(std::exchange(other.raw_ptr_, nullptr))
+        , size_(std::exchange(other.size_, 0)) {
     }
-    
-    ArrayPtr& operator=(ArrayPtr&& other) {
-        raw_ptr_ = std::exchange(other.raw_ptr_, nullptr);
+
+    // Освобождает свою память и забирает память other вместе с его аллокатором.
+    // Аллокаторы, которые нельзя присваивать (как std::pmr::polymorphic_allocator),
+    // должны быть равны — решать, можно ли передавать аллокатор, должен владелец
+    SIMPLE_VECTOR_CONSTEXPR ArrayPtr& operator=(ArrayPtr&& other) noexcept {
+        if (this != &other) {
+            Deallocate();
+            if constexpr (std::is_move_assignable_v<Allocator>) {
+                alloc_ = std::move(other.alloc_);
+            } else {
+                assert(alloc_ == other.alloc_);
+            }
+            raw_ptr_ = std::exchange(other.raw_ptr_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
         return *this;
     }
+
     // Прекращает владением массивом в памяти, возвращает значение адреса массива
     // После вызова метода указатель на массив должен обнулиться
-    [[nodiscard]] Type* Release() noexcept {
-        auto return_ptr = raw_ptr_;
-        raw_ptr_ = nullptr;
-        return return_ptr;
+    [[nodiscard]] SIMPLE_VECTOR_CONSTEXPR Type* Release() noexcept {
+        size_ = 0;
+        return std::exchange(raw_ptr_, nullptr);
     }
 
-    // Возвращает ссылку на элемент массива с индексом index
-    Type& operator[](size_t index) noexcept {
+    // Возвращает ссылку на элемент массива с индексом index.
+    // Объект по этому индексу должен быть создан владельцем массива
+    SIMPLE_VECTOR_CONSTEXPR Type& operator[](size_t index) noexcept {
         return raw_ptr_[index];
     }
 
     // Возвращает константную ссылку на элемент массива с индексом index
-    const Type& operator[](size_t index) const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR const Type& operator[](size_t index) const noexcept {
         return raw_ptr_[index];
     }
 
     // Возвращает true, если указатель ненулевой, и false в противном случае
-    explicit operator bool() const {
-        return raw_ptr_ != nullptr;;
+    SIMPLE_VECTOR_CONSTEXPR explicit operator bool() const {
+        return raw_ptr_ != nullptr;
+    }
+
+    // Меняет размер блока на new_size элементов методом reallocate аллокатора,
+    // если он есть. Байты первых min(GetSize(), new_size) элементов сохраняются,
+    // но блок может переехать, поэтому так можно переносить только тривиально
+    // переносимые объекты. Возвращает false, если блок остался прежним
+    SIMPLE_VECTOR_CONSTEXPR bool TryReallocate(size_t new_size) noexcept {
+        if constexpr (HasReallocate<Allocator>::value) {
+            if (raw_ptr_ != nullptr && new_size != 0) {
+                if (Type* reallocated = alloc_.reallocate(raw_ptr_, size_, new_size)) {
+                    raw_ptr_ = reallocated;
+                    size_ = new_size;
+                    return true;
+                }
+            }
+        } else {
+            static_cast<void>(new_size);
+        }
+        return false;
     }
 
     // Возвращает значение сырого указателя, хранящего адрес начала массива
-    Type* Get() const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR Type* Get() const noexcept {
         return raw_ptr_;
     }
 
-    // Обменивается значениям указателя на массив с объектом other
-    void swap(ArrayPtr& other) noexcept {
-        auto tmp = raw_ptr_;
-        raw_ptr_ = other.raw_ptr_;
-        other.raw_ptr_ = tmp;
+    // Возвращает количество элементов, под которые выделена память
+    SIMPLE_VECTOR_CONSTEXPR size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    // Возвращает аллокатор, которым выделена память
+    SIMPLE_VECTOR_CONSTEXPR Allocator& GetAllocator() noexcept {
+        return alloc_;
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR const Allocator& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Обменивается значениям указателя на массив с объектом other.
+    // Аллокаторы, которые нельзя обменять, должны быть равны
+    SIMPLE_VECTOR_CONSTEXPR void swap(ArrayPtr& other) noexcept {
+        if constexpr (std::is_swappable_v<Allocator>) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        } else {
+            assert(alloc_ == other.alloc_);
+        }
+        std::swap(raw_ptr_, other.raw_ptr_);
+        std::swap(size_, other.size_);
     }
 
 private:
+    [[no_unique_address]] Allocator alloc_;
     Type* raw_ptr_ = nullptr;
-};
\ No newline at end of file
+    size_t size_ = 0;
+
+    SIMPLE_VECTOR_CONSTEXPR void Deallocate() noexcept {
+        if (raw_ptr_ != nullptr) {
+            AllocTraits::deallocate(alloc_, raw_ptr_, size_);
+        }
+    }
+};
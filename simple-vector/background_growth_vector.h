@@ -0,0 +1,194 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <utility>
+
+#include "aligned_allocator.h"
+#include "array_ptr.h"
+#include "growth_policy.h"
+#include "hardening.h"
+#include "simple_vector.h"
+
+// Доля вместимости в процентах, после которой BackgroundGrowthVector заранее
+// готовит следующий буфер
+inline constexpr size_t kDefaultHighWaterPercent = 75;
+// Буферы меньше этого размера выделяются и отображаются быстро, поэтому
+// готовить их в другом потоке дороже, чем выделить на месте
+inline constexpr size_t kBackgroundGrowthMinBytes = size_t{1} << 20;
+
+// Вектор для потока, которому важна задержка каждого добавления. Когда размер
+// достигает high_water_percent процентов вместимости, следующий буфер (его размер
+// задаёт политика роста) выделяется и касается всех своих страниц в фоновом
+// потоке. Перевыделение в EmplaceBack тогда только переносит элементы в готовую
+// память: выделение и страничные отказы нового буфера, которые для больших
+// буферов стоят дороже самого переноса, снимаются с критического пути.
+// Перенос элементов остаётся на нём; если нужна задержка, не зависящая от
+// размера, подходит SegmentedVector, который вообще не переносит элементы.
+// Аллокатор должен допускать выделение памяти в другом потоке. Методы объекта,
+// как и у SimpleVector, нельзя вызывать из нескольких потоков одновременно
+template <typename Type, typename Allocator = std::allocator<Type>, typename GrowthPolicy = DoublingGrowth>
+class BackgroundGrowthVector {
+    using Storage = ArrayPtr<Type, Allocator>;
+
+public:
+    using Vector = SimpleVector<Type, Allocator, GrowthPolicy>;
+    using Iterator = typename Vector::Iterator;
+    using ConstIterator = typename Vector::ConstIterator;
+
+    explicit BackgroundGrowthVector(size_t high_water_percent = kDefaultHighWaterPercent,
+                                    size_t min_background_bytes = kBackgroundGrowthMinBytes)
+        : high_water_percent_(high_water_percent)
+        , min_background_bytes_(min_background_bytes) {
+        SIMPLE_VECTOR_CHECK(high_water_percent > 0 && high_water_percent <= 100, "high water mark must be a percentage");
+    }
+
+    BackgroundGrowthVector(const BackgroundGrowthVector&) = delete;
+    BackgroundGrowthVector& operator=(const BackgroundGrowthVector&) = delete;
+
+    // Дожидается фонового выделения, если оно ещё идёт
+    ~BackgroundGrowthVector() = default;
+
+    size_t GetSize() const noexcept {
+        return items_.GetSize();
+    }
+
+    size_t GetCapacity() const noexcept {
+        return items_.GetCapacity();
+    }
+
+    bool IsEmpty() const noexcept {
+        return items_.IsEmpty();
+    }
+
+    Type& operator[](size_t index) noexcept {
+        return items_[index];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        return items_[index];
+    }
+
+    Type* Data() noexcept {
+        return items_.Data();
+    }
+
+    const Type* Data() const noexcept {
+        return items_.Data();
+    }
+
+    Iterator begin() noexcept {
+        return items_.begin();
+    }
+
+    Iterator end() noexcept {
+        return items_.end();
+    }
+
+    ConstIterator begin() const noexcept {
+        return items_.begin();
+    }
+
+    ConstIterator end() const noexcept {
+        return items_.end();
+    }
+
+    // Возвращает элементы для чтения и алгоритмов над SimpleVector
+    const Vector& GetVector() const noexcept {
+        return items_;
+    }
+
+    // Сообщает, готовится ли следующий буфер или уже готов
+    bool HasPendingGrowth() const noexcept {
+        return pending_.valid();
+    }
+
+    // Сообщает, готов ли следующий буфер, не дожидаясь его
+    bool IsGrowthReady() const {
+        return pending_.valid() && pending_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        if (GetSize() == GetCapacity() && pending_.valid()) {
+            // args могут ссылаться на элементы, которые переедут в новый буфер,
+            // поэтому новый элемент сначала создаётся во временном объекте
+            Type value(std::forward<Args>(args)...);
+            AdoptPendingStorage();
+            return items_.EmplaceBack(std::move(value));
+        }
+        Type& item = items_.EmplaceBack(std::forward<Args>(args)...);
+        MaybeStartGrowth();
+        return item;
+    }
+
+    void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    void PopBack() noexcept {
+        items_.PopBack();
+    }
+
+    // Резервирует память сразу, не в фоне, и касается всех её страниц.
+    // Готовящийся буфер, если он меньше new_capacity, будет отброшен
+    void Reserve(size_t new_capacity) {
+        items_.Reserve(new_capacity);
+        items_.PrefaultCapacity();
+    }
+
+    // Касается всех страниц незанятой вместимости (см. SimpleVector::PrefaultCapacity)
+    void PrefaultCapacity() noexcept {
+        items_.PrefaultCapacity();
+    }
+
+    void Clear() noexcept {
+        items_.Clear();
+    }
+
+private:
+    Vector items_;
+    std::future<Storage> pending_;
+    size_t high_water_percent_;
+    size_t min_background_bytes_;
+
+    // Начинает готовить следующий буфер, если вектор заполнен выше отметки
+    void MaybeStartGrowth() {
+        const size_t capacity = GetCapacity();
+        if (pending_.valid() || capacity * sizeof(Type) < min_background_bytes_ ||
+            GetSize() * 100 < capacity * high_water_percent_) {
+            return;
+        }
+        const size_t next_capacity = GrowthPolicy::NextCapacity(capacity, capacity + 1, sizeof(Type));
+        try {
+            pending_ = std::async(std::launch::async, [alloc = items_.GetAllocator(), next_capacity] {
+                Storage storage(next_capacity, alloc);
+                PrefaultPages(static_cast<void*>(storage.Get()), next_capacity * sizeof(Type));
+                return storage;
+            });
+        } catch (...) {
+            // Не удалось запустить поток: буфер выделит само перевыделение
+        }
+    }
+
+    // Переносит элементы в подготовленный буфер. Если он ещё не готов, ждёт его:
+    // выделение уже идёт, и ждать меньше, чем начинать его заново
+    void AdoptPendingStorage() {
+        Storage storage;
+        try {
+            storage = pending_.get();
+        } catch (...) {
+            // Фоновое выделение не удалось: вектор вырастет как обычно
+            return;
+        }
+        if (storage.GetSize() > GetSize()) {
+            items_.AdoptStorage(std::move(storage));
+        }
+    }
+};
@@ -0,0 +1,685 @@
+// Бенчмарки SimpleVector в сравнении с std::vector на Google Benchmark.
+// Сборка и запуск с выводом результатов в JSON:
+//     g++ -std=c++17 -O2 -DNDEBUG benchmark.cpp -lbenchmark -lpthread -o benchmark
+//     ./benchmark --benchmark_out=results.json --benchmark_out_format=json
+
+#include "aligned_allocator.h"
+#include "background_growth_vector.h"
+#include "buffer_pool.h"
+#include "concurrent_simple_vector.h"
+#include "flat_set.h"
+#include "packed_simple_vector.h"
+#include "realloc_allocator.h"
+#include "segmented_vector.h"
+#include "serialization.h"
+#include "shared_simple_vector.h"
+#include "simple_vector.h"
+#include "soa_vector.h"
+#include "test_types.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+// Тривиально копируемая структура размером 256 байт
+struct Pod256 {
+    uint64_t words[32];
+};
+
+// Создаёт i-е значение элемента. Строки длиннее буфера малых строк,
+// чтобы их копирование обращалось к куче
+template <typename Type>
+Type MakeValue(size_t i) {
+    if constexpr (is_same_v<Type, string>) {
+        return "benchmark string value number "s + to_string(i);
+    } else if constexpr (is_same_v<Type, Pod256>) {
+        Pod256 pod{};
+        pod.words[0] = i;
+        return pod;
+    } else {
+        return Type(i);
+    }
+}
+
+template <typename Type>
+uint64_t Checksum(const Type& value) {
+    if constexpr (is_same_v<Type, string>) {
+        return value.size();
+    } else if constexpr (is_same_v<Type, Pod256>) {
+        return value.words[0];
+    } else if constexpr (is_same_v<Type, X>) {
+        return value.GetX();
+    } else {
+        return static_cast<uint64_t>(value);
+    }
+}
+
+// Единый интерфейс к SimpleVector и std::vector, чтобы один бенчмарк
+// измерял оба контейнера
+template <typename Type, typename Allocator>
+void PushBack(SimpleVector<Type, Allocator>& v, Type value) {
+    v.PushBack(move(value));
+}
+
+template <typename Type>
+void PushBack(vector<Type>& v, Type value) {
+    v.push_back(move(value));
+}
+
+template <typename Type, typename Allocator>
+void Reserve(SimpleVector<Type, Allocator>& v, size_t capacity) {
+    v.Reserve(capacity);
+}
+
+template <typename Type>
+void Reserve(vector<Type>& v, size_t capacity) {
+    v.reserve(capacity);
+}
+
+template <typename Type, typename Allocator>
+void InsertAt(SimpleVector<Type, Allocator>& v, size_t index, Type value) {
+    v.Insert(v.begin() + index, move(value));
+}
+
+template <typename Type>
+void InsertAt(vector<Type>& v, size_t index, Type value) {
+    v.insert(v.begin() + index, move(value));
+}
+
+template <typename Type, typename Allocator>
+void EraseAt(SimpleVector<Type, Allocator>& v, size_t index) {
+    v.Erase(v.begin() + index);
+}
+
+template <typename Type>
+void EraseAt(vector<Type>& v, size_t index) {
+    v.erase(v.begin() + index);
+}
+
+template <typename Type, typename Allocator>
+void Resize(SimpleVector<Type, Allocator>& v, size_t size) {
+    v.Resize(size);
+}
+
+template <typename Type>
+void Resize(vector<Type>& v, size_t size) {
+    v.resize(size);
+}
+
+template <typename Type, typename Allocator>
+size_t SizeOf(const SimpleVector<Type, Allocator>& v) {
+    return v.GetSize();
+}
+
+template <typename Type>
+size_t SizeOf(const vector<Type>& v) {
+    return v.size();
+}
+
+// SegmentedVector поддерживает только операции в конце
+template <typename Type>
+void PushBack(SegmentedVector<Type>& v, Type value) {
+    v.PushBack(move(value));
+}
+
+template <typename Type>
+void Reserve(SegmentedVector<Type>& v, size_t capacity) {
+    v.Reserve(capacity);
+}
+
+template <typename Type>
+void Resize(SegmentedVector<Type>& v, size_t size) {
+    v.Resize(size);
+}
+
+template <typename Type>
+size_t SizeOf(const SegmentedVector<Type>& v) {
+    return v.GetSize();
+}
+
+template <typename Vector>
+using ElementOf = remove_reference_t<decltype(*declval<Vector&>().begin())>;
+
+template <typename Vector>
+Vector MakeFilled(size_t size) {
+    Vector v;
+    Reserve(v, size);
+    for (size_t i = 0; i < size; ++i) {
+        PushBack(v, MakeValue<ElementOf<Vector>>(i));
+    }
+    return v;
+}
+
+template <typename Vector>
+void BenchPushBack(benchmark::State& state) {
+    const size_t size = state.range(0);
+    for (auto _ : state) {
+        Vector v;
+        for (size_t i = 0; i < size; ++i) {
+            PushBack(v, MakeValue<ElementOf<Vector>>(i));
+        }
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+template <typename Vector>
+void BenchPushBackReserved(benchmark::State& state) {
+    const size_t size = state.range(0);
+    for (auto _ : state) {
+        Vector v;
+        Reserve(v, size);
+        for (size_t i = 0; i < size; ++i) {
+            PushBack(v, MakeValue<ElementOf<Vector>>(i));
+        }
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+enum class Position {
+    kFront,
+    kMiddle,
+    kBack
+};
+
+size_t IndexOf(Position position, size_t size) {
+    switch (position) {
+        case Position::kFront:
+            return 0;
+        case Position::kMiddle:
+            return size / 2;
+        case Position::kBack:
+            return size;
+    }
+    return size;
+}
+
+// Вставляет state.range(0) элементов в вектор, каждый раз в позицию position
+template <typename Vector, Position position>
+void BenchInsert(benchmark::State& state) {
+    const size_t count = state.range(0);
+    for (auto _ : state) {
+        Vector v;
+        for (size_t i = 0; i < count; ++i) {
+            InsertAt(v, IndexOf(position, i), MakeValue<ElementOf<Vector>>(i));
+        }
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+// Удаляет все элементы вектора по одному из середины
+template <typename Vector>
+void BenchErase(benchmark::State& state) {
+    const size_t size = state.range(0);
+    for (auto _ : state) {
+        state.PauseTiming();
+        Vector v = MakeFilled<Vector>(size);
+        state.ResumeTiming();
+        while (SizeOf(v) != 0) {
+            EraseAt(v, SizeOf(v) / 2);
+        }
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+// Удаляет каждый второй элемент: по одному через Erase (сдвиг хвоста на каждое
+// удаление, O(n²)) или одним проходом EraseIf
+template <typename Type, bool Batch>
+void BenchEvict(benchmark::State& state) {
+    const size_t size = state.range(0);
+    for (auto _ : state) {
+        state.PauseTiming();
+        SimpleVector<Type> v = MakeFilled<SimpleVector<Type>>(size);
+        state.ResumeTiming();
+        if constexpr (Batch) {
+            size_t index = 0;
+            v.EraseIf([&index](const Type&) {
+                return index++ % 2 == 0;
+            });
+        } else {
+            for (size_t i = 0; i < v.GetSize(); ++i) {
+                v.Erase(v.begin() + i);
+            }
+        }
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+// Увеличивает размер пустого вектора до state.range(0) и уменьшает обратно
+template <typename Vector>
+void BenchResize(benchmark::State& state) {
+    const size_t size = state.range(0);
+    for (auto _ : state) {
+        Vector v;
+        Resize(v, size);
+        benchmark::DoNotOptimize(v.begin());
+        Resize(v, size / 2);
+        Resize(v, size);
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+template <typename Vector>
+void BenchCopy(benchmark::State& state) {
+    const Vector source = MakeFilled<Vector>(state.range(0));
+    for (auto _ : state) {
+        Vector copy(source);
+        benchmark::DoNotOptimize(copy.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Vector>
+void BenchMove(benchmark::State& state) {
+    Vector source = MakeFilled<Vector>(state.range(0));
+    for (auto _ : state) {
+        Vector moved(move(source));
+        benchmark::DoNotOptimize(moved.begin());
+        source = move(moved);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Vector>
+void BenchIterate(benchmark::State& state) {
+    const Vector v = MakeFilled<Vector>(state.range(0));
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (const auto& item : v) {
+            sum += Checksum(item);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(ElementOf<Vector>));
+}
+
+// Сравнивает два равных вектора и вектор с отличием в последнем элементе,
+// так что операторы проходят весь массив
+template <typename Vector>
+void BenchCompare(benchmark::State& state) {
+    const Vector lhs = MakeFilled<Vector>(state.range(0));
+    const Vector equal = MakeFilled<Vector>(state.range(0));
+    Vector greater = MakeFilled<Vector>(state.range(0));
+    *(greater.end() - 1) = MakeValue<ElementOf<Vector>>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs == equal);
+        benchmark::DoNotOptimize(lhs < greater);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(ElementOf<Vector>) * 2);
+}
+
+// Суммирует большой массив float. Буфер AlignedAllocator выровнен по строке кэша
+// и от 2 МиБ отображается большими страницами, что сокращает промахи TLB
+template <typename Vector>
+void BenchScanFloat(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    Vector v(size, 1.0f);
+    for (auto _ : state) {
+        float sum = 0;
+        for (const float item : v) {
+            sum += item;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.counters["huge_pages"] = v.IsHugePageBacked() ? 1 : 0;
+    state.SetBytesProcessed(state.iterations() * size * sizeof(float));
+}
+
+// Сделка из 12 полей по 8 байт, из которых сканирование читает два
+struct Trade {
+    int64_t id;
+    int64_t timestamp;
+    double price;
+    double quantity;
+    int64_t account;
+    int64_t instrument;
+    int64_t venue;
+    int64_t flags;
+    double bid;
+    double ask;
+    double fee;
+    int64_t sequence;
+};
+
+// Те же поля по столбцам: price и quantity — столбцы 2 и 3
+using TradeColumns = SoAVector<int64_t, int64_t, double, double, int64_t, int64_t, int64_t, int64_t, double, double,
+                               double, int64_t>;
+
+// Суммирует price * quantity по записям SimpleVector<Trade>: из каждой строки
+// кэша полезны 16 байт из 64
+void BenchScanTradesAoS(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    SimpleVector<Trade> trades(size);
+    for (size_t i = 0; i < size; ++i) {
+        trades[i].price = static_cast<double>(i);
+        trades[i].quantity = 2.0;
+    }
+    for (auto _ : state) {
+        double notional = 0;
+        for (const Trade& trade : trades) {
+            notional += trade.price * trade.quantity;
+        }
+        benchmark::DoNotOptimize(notional);
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+// То же по двум столбцам SoAVector: читаются только нужные поля
+void BenchScanTradesSoA(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    TradeColumns trades(size);
+    double* const prices = trades.ColumnData<2>();
+    double* const quantities = trades.ColumnData<3>();
+    for (size_t i = 0; i < size; ++i) {
+        prices[i] = static_cast<double>(i);
+        quantities[i] = 2.0;
+    }
+    for (auto _ : state) {
+        double notional = 0;
+        for (size_t i = 0; i < size; ++i) {
+            notional += prices[i] * quantities[i];
+        }
+        benchmark::DoNotOptimize(notional);
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+// Создаёт и уничтожает короткоживущий вектор из state.range(0) элементов, как
+// обработчик запроса. С PooledAllocator блоки берутся из списка потока
+template <typename Vector>
+void BenchShortLived(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        Vector v;
+        for (size_t i = 0; i < size; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        benchmark::DoNotOptimize(v.Data());
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+// Раздаёт вектор из 1 << 20 элементов state.range(0) читателям: SimpleVector
+// копирует элементы для каждого, SharedSimpleVector только увеличивает счётчик
+template <typename Vector>
+void BenchPublish(benchmark::State& state) {
+    const size_t readers = static_cast<size_t>(state.range(0));
+    const Vector config(size_t{1} << 20, 1);
+    for (auto _ : state) {
+        SimpleVector<Vector> copies;
+        copies.Reserve(readers);
+        for (size_t i = 0; i < readers; ++i) {
+            copies.PushBack(config);
+        }
+        benchmark::DoNotOptimize(copies.Data());
+    }
+    state.SetItemsProcessed(state.iterations() * readers);
+}
+
+// Отсортированные идентификаторы с шагом от 1 до 8
+SimpleVector<uint64_t> MakeSortedIds(size_t size) {
+    SimpleVector<uint64_t> ids(size);
+    uint64_t id = uint64_t{1} << 40;
+    for (size_t i = 0; i < size; ++i) {
+        id += 1 + i * 7919 % 8;
+        ids[i] = id;
+    }
+    return ids;
+}
+
+// Распаковывает PackedSimpleVector в переиспользуемый буфер
+void BenchPackedDecode(benchmark::State& state) {
+    const SimpleVector<uint64_t> ids = MakeSortedIds(state.range(0));
+    const PackedSimpleVector<uint64_t> packed(ids);
+    SimpleVector<uint64_t> decoded;
+    for (auto _ : state) {
+        packed.DecodeTo(decoded);
+        benchmark::DoNotOptimize(decoded.Data());
+    }
+    state.counters["bytes_per_value"] = static_cast<double>(packed.MemoryUsage().used_bytes) / packed.GetSize();
+    state.SetItemsProcessed(state.iterations() * packed.GetSize());
+}
+
+// Читает идентификаторы в случайном порядке из упакованного или обычного вектора
+template <typename Vector>
+void BenchIdRandomAccess(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    const SimpleVector<uint64_t> source = MakeSortedIds(size);
+    const Vector ids(source);
+    size_t index = 0;
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < 1024; ++i) {
+            index = (index * 6364136223846793005u + 1442695040888963407u) % size;
+            sum += ids[index];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+
+// Строит таблицу поиска из отсортированных уникальных ids
+template <typename Table>
+Table MakeLookupTable(const SimpleVector<uint64_t>& ids) {
+    if constexpr (is_same_v<Table, EytzingerSet<uint64_t>>) {
+        return Table(SimpleVectorView<const uint64_t>(ids));
+    } else {
+        return Table(ids.begin(), ids.end());
+    }
+}
+
+bool TableContains(const set<uint64_t>& table, uint64_t key) {
+    return table.count(key) != 0;
+}
+
+template <typename Table>
+bool TableContains(const Table& table, uint64_t key) {
+    return table.Contains(key);
+}
+
+// Ищет в таблице случайные ключи, половина из которых есть в таблице
+template <typename Table>
+void BenchLookup(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    const SimpleVector<uint64_t> ids = MakeSortedIds(size);
+    const Table table = MakeLookupTable<Table>(ids);
+    size_t index = 0;
+    for (auto _ : state) {
+        size_t found = 0;
+        for (size_t i = 0; i < 1024; ++i) {
+            index = (index * 6364136223846793005u + 1442695040888963407u) % size;
+            found += TableContains(table, ids[index] + (i & 1)) ? 1 : 0;
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+
+// Строит множество из перемешанных ключей: std::set вставляет их по одному,
+// FlatSet сортирует все один раз
+template <typename Table>
+void BenchBuildSet(benchmark::State& state) {
+    SimpleVector<uint64_t> keys = MakeSortedIds(state.range(0));
+    for (size_t i = keys.GetSize(); i > 1; --i) {
+        swap(keys[i - 1], keys[(i * 2654435761u) % i]);
+    }
+    for (auto _ : state) {
+        Table table(keys.begin(), keys.end());
+        benchmark::DoNotOptimize(&table);
+    }
+    state.SetItemsProcessed(state.iterations() * keys.GetSize());
+}
+
+// Заполняет вектор без Reserve и измеряет самое долгое добавление: его задержку
+// определяет перевыделение, которое BackgroundGrowthVector готовит в фоне
+template <typename Vector>
+void BenchPushBackWorstLatency(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    double worst_ns = 0;
+    for (auto _ : state) {
+        Vector v;
+        for (size_t i = 0; i < size; ++i) {
+            const auto start = chrono::steady_clock::now();
+            v.PushBack(static_cast<int>(i));
+            const chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+            worst_ns = max(worst_ns, elapsed.count());
+        }
+        benchmark::DoNotOptimize(v.Data());
+    }
+    state.counters["worst_push_ns"] = worst_ns;
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+// Записывает вектор в буфер и читает его обратно
+template <typename Type>
+void BenchSerializeRoundTrip(benchmark::State& state) {
+    const SimpleVector<Type> source = MakeFilled<SimpleVector<Type>>(state.range(0));
+    SimpleVector<char> buffer;
+    for (auto _ : state) {
+        buffer.Clear();
+        Serialize(buffer, source);
+        SimpleVector<Type> restored = Deserialize<Type>(buffer.begin(), buffer.GetSize());
+        benchmark::DoNotOptimize(restored.begin());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(Type));
+}
+
+// Общие векторы, в которые добавляют элементы потоки многопоточных бенчмарков
+ConcurrentSimpleVector<int> concurrent_results;
+SimpleVector<int> locked_results;
+mutex locked_results_mutex;
+
+void BenchConcurrentPushBack(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        concurrent_results.Clear();
+    }
+    int value = 0;
+    for (auto _ : state) {
+        concurrent_results.PushBack(value++);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BenchLockedPushBack(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        locked_results.Clear();
+    }
+    int value = 0;
+    for (auto _ : state) {
+        lock_guard guard(locked_results_mutex);
+        locked_results.PushBack(value++);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+constexpr int64_t kMinSize = 1 << 8;
+constexpr int64_t kMaxSize = 1 << 16;
+// Вставка и удаление в начале и середине квадратичны, поэтому их размеры меньше
+constexpr int64_t kMaxShiftSize = 1 << 12;
+
+// Регистрирует бенчмарк для SimpleVector<Type> и std::vector<Type> рядом друг с другом
+#define SIMPLE_VECTOR_BENCHMARK(bench, Type, max_size)                                      \
+    BENCHMARK_TEMPLATE(bench, SimpleVector<Type>)->RangeMultiplier(16)->Range(kMinSize, max_size); \
+    BENCHMARK_TEMPLATE(bench, vector<Type>)->RangeMultiplier(16)->Range(kMinSize, max_size)
+
+#define SIMPLE_VECTOR_INSERT_BENCHMARK(Type, position, max_size)                                                \
+    BENCHMARK_TEMPLATE(BenchInsert, SimpleVector<Type>, position)->RangeMultiplier(16)->Range(kMinSize, max_size); \
+    BENCHMARK_TEMPLATE(BenchInsert, vector<Type>, position)->RangeMultiplier(16)->Range(kMinSize, max_size)
+
+// Бенчмарки, общие для копируемых и некопируемых типов
+#define SIMPLE_VECTOR_COMMON_BENCHMARKS(Type)                                \
+    SIMPLE_VECTOR_BENCHMARK(BenchPushBack, Type, kMaxSize);                 \
+    SIMPLE_VECTOR_BENCHMARK(BenchPushBackReserved, Type, kMaxSize);         \
+    SIMPLE_VECTOR_INSERT_BENCHMARK(Type, Position::kFront, kMaxShiftSize);  \
+    SIMPLE_VECTOR_INSERT_BENCHMARK(Type, Position::kMiddle, kMaxShiftSize); \
+    SIMPLE_VECTOR_INSERT_BENCHMARK(Type, Position::kBack, kMaxSize);        \
+    SIMPLE_VECTOR_BENCHMARK(BenchErase, Type, kMaxShiftSize);               \
+    SIMPLE_VECTOR_BENCHMARK(BenchResize, Type, kMaxSize);                   \
+    SIMPLE_VECTOR_BENCHMARK(BenchMove, Type, kMaxSize);                     \
+    SIMPLE_VECTOR_BENCHMARK(BenchIterate, Type, kMaxSize)
+
+SIMPLE_VECTOR_COMMON_BENCHMARKS(int);
+BENCHMARK_TEMPLATE(BenchPushBack, SegmentedVector<int>)->RangeMultiplier(16)->Range(kMinSize, kMaxSize);
+BENCHMARK_TEMPLATE(BenchResize, SegmentedVector<int>)->RangeMultiplier(16)->Range(kMinSize, kMaxSize);
+BENCHMARK_TEMPLATE(BenchIterate, SegmentedVector<int>)->RangeMultiplier(16)->Range(kMinSize, kMaxSize);
+SIMPLE_VECTOR_BENCHMARK(BenchCopy, int, kMaxSize);
+
+SIMPLE_VECTOR_COMMON_BENCHMARKS(string);
+SIMPLE_VECTOR_BENCHMARK(BenchCopy, string, kMaxSize);
+
+SIMPLE_VECTOR_COMMON_BENCHMARKS(Pod256);
+SIMPLE_VECTOR_BENCHMARK(BenchCopy, Pod256, kMaxSize);
+
+SIMPLE_VECTOR_BENCHMARK(BenchCompare, uint8_t, kMaxSize);
+SIMPLE_VECTOR_BENCHMARK(BenchCompare, int32_t, kMaxSize);
+SIMPLE_VECTOR_BENCHMARK(BenchCompare, float, kMaxSize);
+
+BENCHMARK_TEMPLATE(BenchSerializeRoundTrip, int)->RangeMultiplier(16)->Range(kMinSize, kMaxSize);
+BENCHMARK_TEMPLATE(BenchSerializeRoundTrip, Pod256)->RangeMultiplier(16)->Range(kMinSize, kMaxSize);
+BENCHMARK_TEMPLATE(BenchSerializeRoundTrip, string)->RangeMultiplier(16)->Range(kMinSize, kMaxSize);
+
+BENCHMARK_TEMPLATE(BenchScanFloat, SimpleVector<float>)->Arg(64 << 20);
+BENCHMARK_TEMPLATE(BenchScanFloat, SimpleVector<float, AlignedAllocator<float>>)->Arg(64 << 20);
+
+// Рост без Reserve до 64 МиБ: с ReallocAllocator большие блоки переотображаются mremap
+// вместо копирования элементов
+constexpr int64_t kMaxGrowthSize = 1 << 24;
+BENCHMARK_TEMPLATE(BenchPushBack, SimpleVector<int>)->RangeMultiplier(16)->Range(kMaxSize, kMaxGrowthSize);
+BENCHMARK_TEMPLATE(BenchPushBack, SimpleVector<int, ReallocAllocator<int>>)
+    ->RangeMultiplier(16)
+    ->Range(kMinSize, kMaxGrowthSize);
+
+BENCHMARK_TEMPLATE(BenchPushBackWorstLatency, SimpleVector<int>)->Arg(kMaxGrowthSize)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BenchPushBackWorstLatency, BackgroundGrowthVector<int>)
+    ->Arg(kMaxGrowthSize)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BenchScanTradesAoS)->RangeMultiplier(16)->Range(kMaxShiftSize, 1 << 20);
+BENCHMARK(BenchScanTradesSoA)->RangeMultiplier(16)->Range(kMaxShiftSize, 1 << 20);
+
+BENCHMARK_TEMPLATE(BenchEvict, string, false)->RangeMultiplier(16)->Range(kMinSize, kMaxShiftSize);
+BENCHMARK_TEMPLATE(BenchEvict, string, true)->RangeMultiplier(16)->Range(kMinSize, kMaxSize);
+
+BENCHMARK_TEMPLATE(BenchShortLived, SimpleVector<int>)->Range(16, 4096)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BenchShortLived, SimpleVector<int, PooledAllocator<int>>)
+    ->Range(16, 4096)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BenchPublish, SimpleVector<int>)->RangeMultiplier(4)->Range(1, 64);
+BENCHMARK_TEMPLATE(BenchPublish, SharedSimpleVector<int>)->RangeMultiplier(4)->Range(1, 64);
+
+BENCHMARK(BenchPackedDecode)->RangeMultiplier(16)->Range(kMaxShiftSize, 1 << 24);
+BENCHMARK_TEMPLATE(BenchIdRandomAccess, SimpleVector<uint64_t>)->RangeMultiplier(16)->Range(kMaxShiftSize, 1 << 24);
+BENCHMARK_TEMPLATE(BenchIdRandomAccess, PackedSimpleVector<uint64_t>)
+    ->RangeMultiplier(16)
+    ->Range(kMaxShiftSize, 1 << 24);
+
+BENCHMARK_TEMPLATE(BenchLookup, set<uint64_t>)->RangeMultiplier(16)->Range(16, 1 << 20);
+BENCHMARK_TEMPLATE(BenchLookup, FlatSet<uint64_t>)->RangeMultiplier(16)->Range(16, 1 << 20);
+BENCHMARK_TEMPLATE(BenchLookup, EytzingerSet<uint64_t>)->RangeMultiplier(16)->Range(16, 1 << 20);
+BENCHMARK_TEMPLATE(BenchBuildSet, set<uint64_t>)->RangeMultiplier(16)->Range(16, 1 << 20);
+BENCHMARK_TEMPLATE(BenchBuildSet, FlatSet<uint64_t>)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+BENCHMARK(BenchConcurrentPushBack)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BenchLockedPushBack)->ThreadRange(1, 8)->UseRealTime();
+
+// X нельзя копировать, поэтому для него нет бенчмарка копирования
+SIMPLE_VECTOR_COMMON_BENCHMARKS(X);
+
+BENCHMARK_MAIN();
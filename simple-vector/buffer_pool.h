@@ -0,0 +1,241 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Классы размеров BufferPool: степени двойки от 16 байт до 1 МиБ.
+// Блоки крупнее выделяются и освобождаются напрямую
+inline constexpr size_t kPoolMinClassShift = 4;
+inline constexpr size_t kPoolMaxClassShift = 20;
+inline constexpr size_t kPoolClassCount = kPoolMaxClassShift - kPoolMinClassShift + 1;
+// Сколько свободных блоков каждого класса поток хранит по умолчанию
+inline constexpr size_t kDefaultPoolClassLimit = 16;
+
+// Статистика пула текущего потока
+struct BufferPoolStats {
+    // Сколько выделений обслужено из свободных блоков и сколько — через operator new
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t cached_blocks = 0;
+    size_t cached_bytes = 0;
+};
+
+// Пул освобождённых блоков памяти со списком свободных блоков на каждый класс
+// размеров в каждом потоке. Выделение и освобождение не берут блокировок и не
+// обращаются к общему аллокатору, пока в списке потока есть блок нужного класса,
+// поэтому короткоживущие векторы не соревнуются за кучу. Размер блока округляется
+// вверх до класса. Блок, освобождённый другим потоком, попадает в его список.
+// Списки потока освобождаются при его завершении, при TrimCurrentThread и при
+// следующем обращении потока к пулу после TrimAllThreads
+class BufferPool {
+public:
+    // Возвращает номер класса для блока из bytes байт или kPoolClassCount,
+    // если такие блоки не кэшируются
+    static constexpr size_t GetClassIndex(size_t bytes) noexcept {
+        size_t index = 0;
+        while (index < kPoolClassCount && GetClassBytes(index) < bytes) {
+            ++index;
+        }
+        return index;
+    }
+
+    static constexpr size_t GetClassBytes(size_t class_index) noexcept {
+        return size_t{1} << (class_index + kPoolMinClassShift);
+    }
+
+    static void* Allocate(size_t bytes) {
+        const size_t index = GetClassIndex(bytes);
+        if (index == kPoolClassCount || IsThreadCacheDestroyed()) {
+            return ::operator new(bytes);
+        }
+        ThreadCache& cache = GetThreadCache();
+        ClassList& list = cache.lists[index];
+        if (list.head != nullptr) {
+            ++cache.hits;
+            FreeBlock* block = list.head;
+            list.head = block->next;
+            --list.count;
+            return block;
+        }
+        ++cache.misses;
+        return ::operator new(GetClassBytes(index));
+    }
+
+    // Освобождает блок из bytes байт, выделенный Allocate(bytes)
+    static void Deallocate(void* block, size_t bytes) noexcept {
+        const size_t index = GetClassIndex(bytes);
+        if (index == kPoolClassCount || IsThreadCacheDestroyed()) {
+            ::operator delete(block);
+            return;
+        }
+        ClassList& list = GetThreadCache().lists[index];
+        if (list.count >= GetClassLimit(index)) {
+            ::operator delete(block);
+            return;
+        }
+        list.head = ::new (block) FreeBlock{list.head};
+        ++list.count;
+    }
+
+    // Задаёт, сколько свободных блоков класса class_index хранит каждый поток.
+    // 0 отключает кэширование класса. Уже сохранённые блоки сверх лимита
+    // остаются в списках до очистки пула
+    static void SetClassLimit(size_t class_index, size_t max_blocks) noexcept {
+        GetLimits().values[class_index].store(max_blocks, std::memory_order_relaxed);
+    }
+
+    static size_t GetClassLimit(size_t class_index) noexcept {
+        return GetLimits().values[class_index].load(std::memory_order_relaxed);
+    }
+
+    // Возвращает системе свободные блоки текущего потока
+    static void TrimCurrentThread() noexcept {
+        if (!IsThreadCacheDestroyed()) {
+            GetThreadCache().Release();
+        }
+    }
+
+    // Просит все потоки вернуть системе свободные блоки. Поток делает это сам
+    // при следующем обращении к пулу, поэтому вызов не ждёт других потоков
+    static void TrimAllThreads() noexcept {
+        GetTrimEpoch().fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static BufferPoolStats GetThreadStats() noexcept {
+        BufferPoolStats stats;
+        if (IsThreadCacheDestroyed()) {
+            return stats;
+        }
+        const ThreadCache& cache = GetThreadCache();
+        stats.hits = cache.hits;
+        stats.misses = cache.misses;
+        for (size_t index = 0; index < kPoolClassCount; ++index) {
+            stats.cached_blocks += cache.lists[index].count;
+            stats.cached_bytes += cache.lists[index].count * GetClassBytes(index);
+        }
+        return stats;
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct ClassList {
+        FreeBlock* head = nullptr;
+        size_t count = 0;
+    };
+
+    struct ThreadCache {
+        ClassList lists[kPoolClassCount];
+        uint64_t trim_epoch = GetTrimEpoch().load(std::memory_order_relaxed);
+        size_t hits = 0;
+        size_t misses = 0;
+
+        ThreadCache() = default;
+        ThreadCache(const ThreadCache&) = delete;
+        ThreadCache& operator=(const ThreadCache&) = delete;
+
+        ~ThreadCache() {
+            Release();
+            GetDestroyedFlag() = true;
+        }
+
+        void Release() noexcept {
+            for (ClassList& list : lists) {
+                while (list.head != nullptr) {
+                    ::operator delete(std::exchange(list.head, list.head->next));
+                }
+                list.count = 0;
+            }
+        }
+    };
+
+    struct Limits {
+        std::atomic<size_t> values[kPoolClassCount];
+
+        Limits() noexcept {
+            for (std::atomic<size_t>& value : values) {
+                value.store(kDefaultPoolClassLimit, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    static Limits& GetLimits() noexcept {
+        static Limits limits;
+        return limits;
+    }
+
+    static std::atomic<uint64_t>& GetTrimEpoch() noexcept {
+        static std::atomic<uint64_t> epoch{0};
+        return epoch;
+    }
+
+    // Возвращает списки потока, сначала выполнив запрошенную TrimAllThreads очистку
+    static ThreadCache& GetThreadCache() noexcept {
+        thread_local ThreadCache cache;
+        const uint64_t epoch = GetTrimEpoch().load(std::memory_order_relaxed);
+        if (cache.trim_epoch != epoch) {
+            cache.Release();
+            cache.trim_epoch = epoch;
+        }
+        return cache;
+    }
+
+    // Векторы в thread_local и статических переменных могут освобождать память
+    // после того, как списки потока уже разрушены. Флаг тривиален, поэтому читать
+    // его можно до конца жизни потока
+    static bool& GetDestroyedFlag() noexcept {
+        thread_local bool destroyed = false;
+        return destroyed;
+    }
+
+    static bool IsThreadCacheDestroyed() noexcept {
+        return GetDestroyedFlag();
+    }
+};
+
+// Аллокатор, берущий блоки из BufferPool. Пул выдаёт блоки целого класса размеров,
+// поэтому вместе с ним удобно использовать AllocationRoundingGrowth: тогда
+// вместимость вектора занимает весь блок
+template <typename Type>
+class PooledAllocator {
+    static_assert(alignof(Type) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "BufferPool does not support extended alignment");
+
+public:
+    using value_type = Type;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    PooledAllocator() noexcept = default;
+
+    template <typename Other>
+    PooledAllocator(const PooledAllocator<Other>& /*other*/) noexcept {
+    }
+
+    [[nodiscard]] Type* allocate(size_t count) {
+        if (count > std::numeric_limits<size_t>::max() / sizeof(Type)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<Type*>(BufferPool::Allocate(count * sizeof(Type)));
+    }
+
+    void deallocate(Type* ptr, size_t count) noexcept {
+        BufferPool::Deallocate(ptr, count * sizeof(Type));
+    }
+};
+
+template <typename Lhs, typename Rhs>
+bool operator==(const PooledAllocator<Lhs>&, const PooledAllocator<Rhs>&) noexcept {
+    return true;
+}
+
+template <typename Lhs, typename Rhs>
+bool operator!=(const PooledAllocator<Lhs>&, const PooledAllocator<Rhs>&) noexcept {
+    return false;
+}
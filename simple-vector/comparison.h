@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "constexpr_support.h"
+
+// Сравнение непрерывных массивов элементов для операторов сравнения векторов.
+// Равенство массивов целых чисел проверяется memcmp. Для порядка арифметических
+// типов сначала ищется первый байт, в котором массивы различаются (инструкциями
+// AVX2 или NEON, если они доступны при сборке), и оператором типа сравнивается
+// только элемент с этим байтом. Для остальных типов используются std::equal
+// и std::lexicographical_compare, они же — во время компиляции
+
+// Элементы с одинаковыми байтами эквивалентны: ни один не меньше другого.
+// Обратное для чисел с плавающей точкой неверно: байты 0.0 и -0.0 различаются
+template <typename Type>
+inline constexpr bool IsBytewiseComparableV = std::is_arithmetic_v<Type>;
+
+// Элементы равны тогда и только тогда, когда равны их байты, поэтому равенство
+// массивов проверяется одним memcmp. Числа с плавающей точкой сюда не входят:
+// NaN не равен даже NaN с теми же байтами
+template <typename Type>
+inline constexpr bool IsBytewiseEqualityV =
+    IsBytewiseComparableV<Type> && std::has_unique_object_representations_v<Type>;
+
+// Лексикографический порядок байтов совпадает с порядком элементов
+template <typename Type>
+inline constexpr bool IsBytewiseOrderedV =
+    IsBytewiseComparableV<Type> && sizeof(Type) == 1 && std::is_unsigned_v<Type>;
+
+// Возвращает индекс первого различающегося байта массивов lhs и rhs длиной size байт
+// или size, если массивы совпадают
+inline size_t FindFirstByteMismatch(const unsigned char* lhs, const unsigned char* rhs, size_t size) noexcept {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= size; i += 32) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+        const uint32_t equal_mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+        if (equal_mask != 0xFFFFFFFFu) {
+            return i + __builtin_ctz(~equal_mask);
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; i + 16 <= size; i += 16) {
+        const uint8x16_t equal = vceqq_u8(vld1q_u8(lhs + i), vld1q_u8(rhs + i));
+        if (vminvq_u8(equal) != 0xFF) {
+            // Сжимает маску до 4 бит на байт, чтобы найти первый ноль
+            const uint64_t nibbles =
+                vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(equal), 4)), 0);
+            return i + __builtin_ctzll(~nibbles) / 4;
+        }
+    }
+#endif
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t a;
+        uint64_t b;
+        std::memcpy(&a, lhs + i, sizeof(a));
+        std::memcpy(&b, rhs + i, sizeof(b));
+        if (a != b) {
+            break;
+        }
+    }
+    for (; i < size; ++i) {
+        if (lhs[i] != rhs[i]) {
+            return i;
+        }
+    }
+    return size;
+}
+
+// Возвращает индекс первого элемента, байты которого в lhs и rhs различаются,
+// или count, если таких нет
+template <typename Type>
+size_t FindFirstBytewiseMismatch(const Type* lhs, const Type* rhs, size_t count) noexcept {
+    if (count == 0) {
+        return 0;
+    }
+    return FindFirstByteMismatch(reinterpret_cast<const unsigned char*>(lhs),
+                                 reinterpret_cast<const unsigned char*>(rhs), count * sizeof(Type)) /
+           sizeof(Type);
+}
+
+// Проверяет, что массивы lhs и rhs из count элементов поэлементно равны
+template <typename Type>
+SIMPLE_VECTOR_CONSTEXPR bool RangesEqual(const Type* lhs, const Type* rhs, size_t count) {
+    if constexpr (IsBytewiseEqualityV<Type>) {
+        if (!IsConstantEvaluated()) {
+            return count == 0 || std::memcmp(lhs, rhs, count * sizeof(Type)) == 0;
+        }
+    }
+    return std::equal(lhs, lhs + count, rhs);
+}
+
+// Проверяет, что массив lhs лексикографически меньше массива rhs
+template <typename Type>
+SIMPLE_VECTOR_CONSTEXPR bool RangesLess(const Type* lhs, size_t lhs_size, const Type* rhs, size_t rhs_size) {
+    if (IsConstantEvaluated()) {
+        return std::lexicographical_compare(lhs, lhs + lhs_size, rhs, rhs + rhs_size);
+    }
+    const size_t common = std::min(lhs_size, rhs_size);
+    if constexpr (IsBytewiseOrderedV<Type>) {
+        const int order = common == 0 ? 0 : std::memcmp(lhs, rhs, common);
+        return order < 0 || (order == 0 && lhs_size < rhs_size);
+    } else if constexpr (IsBytewiseComparableV<Type>) {
+        // Элементы, ни один из которых не меньше другого, считаются эквивалентными,
+        // как в std::lexicographical_compare
+        for (size_t i = 0; (i += FindFirstBytewiseMismatch(lhs + i, rhs + i, common - i)) < common; ++i) {
+            if (lhs[i] < rhs[i]) {
+                return true;
+            }
+            if (rhs[i] < lhs[i]) {
+                return false;
+            }
+        }
+        return lhs_size < rhs_size;
+    } else {
+        return std::lexicographical_compare(lhs, lhs + lhs_size, rhs, rhs + rhs_size);
+    }
+}
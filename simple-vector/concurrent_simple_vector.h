@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "array_ptr.h"
+#include "hardening.h"
+#include "uninitialized.h"
+
+using namespace std::literals;
+
+// Вектор, в который могут одновременно добавлять элементы несколько потоков.
+// Элементы хранятся в сегментах, размеры которых растут вдвое: сегмент s вмещает
+// FirstSegmentSize * 2^s элементов. При росте выделяется новый сегмент, а созданные
+// элементы не переносятся, поэтому ссылки на них остаются действительными.
+//
+// PushBack и EmplaceBack не блокируют другие потоки: индекс элемента занимается
+// атомарным fetch_add, а сегмент выделяет тот поток, который первым до него дошёл.
+// GetSize возвращает число элементов, которые уже созданы и видны всем потокам:
+// все элементы с индексами меньше GetSize можно читать одновременно с добавлением.
+// Clear, деструктор и изменение самих элементов с добавлением не синхронизируются.
+// Аллокатор должен допускать одновременные вызовы из разных потоков
+template <typename Type, typename Allocator = std::allocator<Type>, size_t FirstSegmentSize = 8>
+class ConcurrentSimpleVector {
+    static_assert(FirstSegmentSize > 0 && (FirstSegmentSize & (FirstSegmentSize - 1)) == 0,
+                  "first segment size must be a power of two");
+
+    // Сегмент с элементами и флагами их готовности
+    struct Segment {
+        Segment(size_t size, const Allocator& alloc)
+            : items(size, alloc)
+            , ready(new std::atomic<bool>[size]()) {
+        }
+
+        ArrayPtr<Type, Allocator> items;
+        std::unique_ptr<std::atomic<bool>[]> ready;
+    };
+
+    // Сегментов хватает для любого индекса типа size_t
+    static constexpr size_t kSegmentCount = sizeof(size_t) * 8;
+
+public:
+    using AllocatorType = Allocator;
+
+    ConcurrentSimpleVector() = default;
+
+    explicit ConcurrentSimpleVector(const Allocator& alloc)
+        : alloc_(alloc) {
+    }
+
+    ConcurrentSimpleVector(const ConcurrentSimpleVector&) = delete;
+    ConcurrentSimpleVector& operator=(const ConcurrentSimpleVector&) = delete;
+
+    ~ConcurrentSimpleVector() {
+        Clear();
+    }
+
+    // Добавляет элемент в конец вектора и возвращает ссылку на него.
+    // Если выделение сегмента или создание элемента выбрасывает исключение,
+    // его индекс остаётся пустым и GetSize больше не растёт выше этого индекса
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        const size_t index = claimed_.fetch_add(1);
+        const size_t segment = SegmentOf(index);
+        Segment& storage = AcquireSegment(segment);
+        const size_t offset = index - SegmentBegin(segment);
+        Type* slot = storage.items.Get() + offset;
+        Construct(storage.items.GetAllocator(), slot, std::forward<Args>(args)...);
+        storage.ready[offset].store(true);
+        Publish();
+        return *slot;
+    }
+
+    void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    // Выделяет сегменты под capacity элементов, чтобы добавление до этого размера
+    // не выделяло память. Можно вызывать одновременно с добавлением
+    void Reserve(size_t capacity) {
+        if (capacity == 0) {
+            return;
+        }
+        for (size_t segment = 0; segment <= SegmentOf(capacity - 1); ++segment) {
+            AcquireSegment(segment);
+        }
+    }
+
+    // Возвращает количество элементов, созданных и доступных для чтения
+    size_t GetSize() const noexcept {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    // Возвращает ссылку на элемент с индексом index < GetSize()
+    Type& operator[](size_t index) noexcept {
+        SIMPLE_VECTOR_CHECK(index < GetSize(), "index out of range");
+        return *ItemAt(index);
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        SIMPLE_VECTOR_CHECK(index < GetSize(), "index out of range");
+        return *ItemAt(index);
+    }
+
+    // Возвращает ссылку на элемент с индексом index
+    // Выбрасывает исключение std::out_of_range, если index >= GetSize()
+    Type& At(size_t index) {
+        if (index >= GetSize()) {
+            throw std::out_of_range("index out of range"s);
+        }
+        return *ItemAt(index);
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= GetSize()) {
+            throw std::out_of_range("index out of range"s);
+        }
+        return *ItemAt(index);
+    }
+
+    // Разрушает элементы и освобождает сегменты.
+    // Нельзя вызывать одновременно с другими методами
+    void Clear() noexcept {
+        const size_t claimed = claimed_.load();
+        for (size_t segment = 0; segment < kSegmentCount; ++segment) {
+            Segment* storage = segments_[segment].exchange(nullptr);
+            if (storage == nullptr) {
+                continue;
+            }
+            const size_t begin = SegmentBegin(segment);
+            const size_t count = begin < claimed ? std::min(claimed - begin, SegmentSize(segment)) : 0;
+            for (size_t offset = 0; offset < count; ++offset) {
+                if (storage->ready[offset].load()) {
+                    DestroyN(storage->items.GetAllocator(), storage->items.Get() + offset, 1);
+                }
+            }
+            delete storage;
+        }
+        claimed_.store(0);
+        size_.store(0);
+    }
+
+private:
+    [[no_unique_address]] Allocator alloc_;
+    std::array<std::atomic<Segment*>, kSegmentCount> segments_{};
+    // Количество индексов, выданных добавляющим потокам
+    std::atomic<size_t> claimed_ = 0;
+    // Длина начала вектора, в котором все элементы созданы
+    std::atomic<size_t> size_ = 0;
+
+    static size_t SegmentOf(size_t index) noexcept {
+        const size_t block = index / FirstSegmentSize + 1;
+        return kSegmentCount - 1 - static_cast<size_t>(__builtin_clzll(static_cast<unsigned long long>(block)));
+    }
+
+    static size_t SegmentBegin(size_t segment) noexcept {
+        return FirstSegmentSize * ((size_t{1} << segment) - 1);
+    }
+
+    static size_t SegmentSize(size_t segment) noexcept {
+        return FirstSegmentSize << segment;
+    }
+
+    // Возвращает сегмент, выделяя его, если его ещё нет. Если несколько потоков
+    // выделили сегмент одновременно, остаётся один, а остальные освобождаются
+    Segment& AcquireSegment(size_t segment) {
+        Segment* storage = segments_[segment].load(std::memory_order_acquire);
+        if (storage != nullptr) {
+            return *storage;
+        }
+        if ((std::allocator_traits<Allocator>::max_size(alloc_) >> segment) < FirstSegmentSize) {
+            throw std::length_error("ConcurrentSimpleVector is too long"s);
+        }
+        auto created = std::make_unique<Segment>(SegmentSize(segment), alloc_);
+        if (segments_[segment].compare_exchange_strong(storage, created.get(), std::memory_order_acq_rel)) {
+            return *created.release();
+        }
+        return *storage;
+    }
+
+    // Возвращает указатель на элемент, память под который уже выделена
+    Type* ItemAt(size_t index) const noexcept {
+        const size_t segment = SegmentOf(index);
+        return segments_[segment].load(std::memory_order_acquire)->items.Get() + (index - SegmentBegin(segment));
+    }
+
+    bool IsReady(size_t index) const noexcept {
+        const size_t segment = SegmentOf(index);
+        const Segment* storage = segments_[segment].load(std::memory_order_acquire);
+        return storage != nullptr && storage->ready[index - SegmentBegin(segment)].load();
+    }
+
+    // Продвигает size_ по подряд созданным элементам. Флаги готовности
+    // записываются и читаются с последовательной согласованностью, поэтому
+    // из двух потоков, создавших соседние элементы, хотя бы один увидит оба
+    void Publish() noexcept {
+        size_t size = size_.load();
+        while (size < claimed_.load() && IsReady(size)) {
+            if (size_.compare_exchange_weak(size, size + 1)) {
+                ++size;
+            }
+        }
+    }
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <memory>
+#include <type_traits>
+
+// В C++20 память можно выделять и освобождать во время компиляции, если она
+// освобождается до конца вычисления. Тогда SIMPLE_VECTOR_CONSTEXPR раскрывается
+// в constexpr, и SimpleVector можно заполнить в constexpr-функции, а результат
+// скопировать в std::array (см. ToArray). В C++17 макрос пуст
+#if defined(__cpp_constexpr_dynamic_alloc) && defined(__cpp_lib_constexpr_dynamic_alloc) && \
+    defined(__cpp_lib_is_constant_evaluated)
+#define SIMPLE_VECTOR_CONSTEXPR constexpr
+#define SIMPLE_VECTOR_HAS_CONSTEXPR 1
+#else
+#define SIMPLE_VECTOR_CONSTEXPR
+#define SIMPLE_VECTOR_HAS_CONSTEXPR 0
+#endif
+
+// Сообщает, вычисляется ли вызов во время компиляции. Там нельзя использовать
+// memcpy и memmove, поэтому алгоритмы переключаются на поэлементные версии.
+// Во время выполнения условие ложно и ветка исчезает при компиляции
+constexpr bool IsConstantEvaluated() noexcept {
+#if SIMPLE_VECTOR_HAS_CONSTEXPR
+    return std::is_constant_evaluated();
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,303 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "flat_set.h"
+#include "hardening.h"
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+using namespace std::literals;
+
+// Упорядоченный словарь на двух SimpleVector: отсортированных ключей и значений
+// под теми же индексами. Поиск двоичный и читает только массив ключей, поэтому
+// небольшой словарь помещается в несколько строк кэша, в отличие от std::map.
+// Вставка и удаление одного ключа сдвигают хвосты обоих массивов за O(size):
+// словарь выгоднее строить сразу или пополнять пачками через InsertRange.
+// Итератора по парам нет, как и в SoAVector: обходить удобнее Keys() и Values().
+// Указатели и ссылки на значения действительны до изменения состава словаря
+template <typename Key, typename Value, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>>
+class FlatMap {
+    using ValueAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Value>;
+    using KeyVector = SimpleVector<Key, Allocator>;
+    using ValueVector = SimpleVector<Value, ValueAllocator>;
+
+public:
+    using Entry = std::pair<Key, Value>;
+
+    FlatMap() = default;
+
+    // Создаёт словарь из пар диапазона [first, last). Пары сортируются один раз;
+    // из пар с одинаковыми ключами остаётся первая
+    template <typename InputIt, EnableIfInputIterator<InputIt> = 0>
+    FlatMap(InputIt first, InputIt last, const Compare& comp = Compare())
+        : comp_(comp) {
+        InsertRange(first, last);
+    }
+
+    FlatMap(std::initializer_list<Entry> init, const Compare& comp = Compare())
+        : FlatMap(init.begin(), init.end(), comp) {
+    }
+
+    size_t GetSize() const noexcept {
+        return keys_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept {
+        return keys_.IsEmpty();
+    }
+
+    // Возвращает отсортированные ключи
+    SimpleVectorView<const Key> Keys() const noexcept {
+        return SimpleVectorView<const Key>(keys_.Data(), keys_.GetSize());
+    }
+
+    // Возвращает значения в порядке ключей
+    SimpleVectorView<Value> Values() noexcept {
+        return SimpleVectorView<Value>(values_.Data(), values_.GetSize());
+    }
+
+    SimpleVectorView<const Value> Values() const noexcept {
+        return SimpleVectorView<const Value>(values_.Data(), values_.GetSize());
+    }
+
+    // Возвращает значение по ключу key или nullptr
+    Value* Find(const Key& key) {
+        const size_t index = IndexOf(key);
+        return index == GetSize() ? nullptr : values_.Data() + index;
+    }
+
+    const Value* Find(const Key& key) const {
+        const size_t index = IndexOf(key);
+        return index == GetSize() ? nullptr : values_.Data() + index;
+    }
+
+    bool Contains(const Key& key) const {
+        return IndexOf(key) != GetSize();
+    }
+
+    // Выбрасывает исключение std::out_of_range, если ключа key нет
+    Value& At(const Key& key) {
+        Value* value = Find(key);
+        if (value == nullptr) {
+            throw std::out_of_range("key not found"s);
+        }
+        return *value;
+    }
+
+    const Value& At(const Key& key) const {
+        const Value* value = Find(key);
+        if (value == nullptr) {
+            throw std::out_of_range("key not found"s);
+        }
+        return *value;
+    }
+
+    // Возвращает значение по ключу key, вставив значение по умолчанию, если ключа нет
+    Value& operator[](const Key& key) {
+        return *TryEmplace(key).first;
+    }
+
+    // Создаёт значение из args и вставляет его по ключу key, если ключа ещё нет.
+    // Возвращает значение по ключу и признак того, что оно вставлено
+    template <typename... Args>
+    std::pair<Value*, bool> TryEmplace(const Key& key, Args&&... args) {
+        const size_t index = LowerBoundIndex(key);
+        if (index != GetSize() && !comp_(key, keys_[index])) {
+            return {values_.Data() + index, false};
+        }
+        values_.Emplace(values_.cbegin() + index, std::forward<Args>(args)...);
+        try {
+            keys_.Insert(keys_.cbegin() + index, key);
+        } catch (...) {
+            values_.Erase(values_.cbegin() + index);
+            throw;
+        }
+        return {values_.Data() + index, true};
+    }
+
+    // Вставляет value по ключу key, если ключа ещё нет. Возвращает, вставлено ли значение
+    bool Insert(const Key& key, Value value) {
+        return TryEmplace(key, std::move(value)).second;
+    }
+
+    // Вставляет value по ключу key или заменяет им прежнее значение.
+    // Возвращает, был ли ключ вставлен
+    bool InsertOrAssign(const Key& key, Value value) {
+        const auto [slot, inserted] = TryEmplace(key, std::move(value));
+        if (!inserted) {
+            *slot = std::move(value);
+        }
+        return inserted;
+    }
+
+    // Вставляет пары диапазона [first, last), ключей которых ещё нет в словаре;
+    // из пар с одинаковыми ключами вставляется первая. Пары сортируются отдельно
+    // и сливаются со словарём за один проход, поэтому вставка m пар стоит
+    // O(m log m + size), а не O(m * size). Если все новые ключи больше имеющихся,
+    // пары просто дописываются в конец
+    template <typename InputIt, EnableIfInputIterator<InputIt> = 0>
+    void InsertRange(InputIt first, InputIt last) {
+        SimpleVector<Entry> entries(first, last);
+        auto key_less = [this](const Entry& lhs, const Entry& rhs) {
+            return comp_(lhs.first, rhs.first);
+        };
+        SortUnique(entries, key_less);
+        const Key* const existing_begin = keys_.Data();
+        const Key* const existing_end = existing_begin + keys_.GetSize();
+        entries.EraseIf([this, cursor = existing_begin, existing_end](const Entry& entry) mutable {
+            cursor = std::lower_bound(cursor, existing_end, entry.first, comp_);
+            return cursor != existing_end && !comp_(entry.first, *cursor);
+        });
+        if (entries.IsEmpty()) {
+            return;
+        }
+        KeyVector new_keys(keys_.GetAllocator());
+        ValueVector new_values(values_.GetAllocator());
+        new_keys.Reserve(entries.GetSize());
+        new_values.Reserve(entries.GetSize());
+        for (Entry& entry : entries) {
+            new_keys.PushBack(std::move(entry.first));
+            new_values.PushBack(std::move(entry.second));
+        }
+        if (IsEmpty() || comp_(existing_end[-1], new_keys[0])) {
+            AppendColumns(new_keys, new_values);
+        } else {
+            MergeColumns(new_keys, new_values);
+        }
+    }
+
+    // Удаляет ключ key и его значение. Возвращает, был ли ключ
+    bool Erase(const Key& key) {
+        const size_t index = IndexOf(key);
+        if (index == GetSize()) {
+            return false;
+        }
+        keys_.Erase(keys_.cbegin() + index);
+        values_.Erase(values_.cbegin() + index);
+        return true;
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        values_.Clear();
+    }
+
+    void Reserve(size_t new_capacity) {
+        keys_.Reserve(new_capacity);
+        values_.Reserve(new_capacity);
+    }
+
+    // Возвращает, сколько байт выделено под ключи и значения и сколько из них занято
+    VectorMemoryUsage MemoryUsage() const noexcept {
+        VectorMemoryUsage usage = keys_.MemoryUsage();
+        const VectorMemoryUsage values = values_.MemoryUsage();
+        usage.reserved_bytes += values.reserved_bytes;
+        usage.used_bytes += values.used_bytes;
+        return usage;
+    }
+
+    void swap(FlatMap& other) noexcept {
+        std::swap(comp_, other.comp_);
+        keys_.swap(other.keys_);
+        values_.swap(other.values_);
+    }
+
+private:
+    Compare comp_;
+    KeyVector keys_;
+    ValueVector values_;
+
+    size_t LowerBoundIndex(const Key& key) const {
+        return static_cast<size_t>(BranchlessLowerBound(keys_.Data(), GetSize(), key, comp_) - keys_.Data());
+    }
+
+    // Возвращает индекс ключа key или GetSize(), если ключа нет
+    size_t IndexOf(const Key& key) const {
+        const size_t index = LowerBoundIndex(key);
+        return index != GetSize() && !comp_(key, keys_[index]) ? index : GetSize();
+    }
+
+    void AppendColumns(KeyVector& keys, ValueVector& values) {
+        const size_t old_size = GetSize();
+        keys_.Insert(keys_.cend(), std::make_move_iterator(keys.Data()),
+                     std::make_move_iterator(keys.Data() + keys.GetSize()));
+        try {
+            values_.Insert(values_.cend(), std::make_move_iterator(values.Data()),
+                           std::make_move_iterator(values.Data() + values.GetSize()));
+        } catch (...) {
+            keys_.Erase(keys_.cbegin() + old_size, keys_.cend());
+            throw;
+        }
+    }
+
+    // Сливает словарь с отсортированными новыми ключами keys и значениями values.
+    // Сначала по ключам составляется план слияния, а по нему строятся новые столбцы.
+    // Первым строится столбец, элементы которого копируются: если копирование
+    // бросит исключение, ни один прежний элемент ещё не перемещён
+    void MergeColumns(KeyVector& keys, ValueVector& values) {
+        const size_t total = GetSize() + keys.GetSize();
+        SimpleVector<bool> from_existing(total);
+        for (size_t i = 0, existing = 0, incoming = 0; i < total; ++i) {
+            from_existing[i] = incoming == keys.GetSize() ||
+                               (existing != GetSize() && comp_(keys_[existing], keys[incoming]));
+            ++(from_existing[i] ? existing : incoming);
+        }
+        KeyVector merged_keys(keys_.GetAllocator());
+        ValueVector merged_values(values_.GetAllocator());
+        // Память выделяется заранее, чтобы после переноса первого столбца
+        // второй уже не мог прерваться нехваткой памяти
+        merged_keys.Reserve(total);
+        merged_values.Reserve(total);
+        auto build_keys = [&] {
+            MergeColumn(merged_keys, keys_, keys, from_existing);
+        };
+        auto build_values = [&] {
+            MergeColumn(merged_values, values_, values, from_existing);
+        };
+        if constexpr (IsRelocatedByMoveV<Key>) {
+            build_values();
+            build_keys();
+        } else {
+            build_keys();
+            build_values();
+        }
+        keys_.swap(merged_keys);
+        values_.swap(merged_values);
+    }
+
+    template <typename Column>
+    static void MergeColumn(Column& merged, Column& existing, Column& incoming, const SimpleVector<bool>& plan) {
+        using Item = std::remove_reference_t<decltype(existing[0])>;
+        using ItemAllocator = typename Column::AllocatorType;
+        merged.AppendConstructed(plan.GetSize(), [&](ItemAllocator& alloc, Item* dest, size_t count) {
+            size_t step = 0;
+            UninitializedMergeN(alloc, dest, count, existing.Data(), incoming.Data(), [&](const Item*, const Item*) {
+                return plan[step++];
+            });
+        });
+    }
+};
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void swap(FlatMap<Key, Value, Compare, Allocator>& lhs, FlatMap<Key, Value, Compare, Allocator>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool operator==(const FlatMap<Key, Value, Compare, Allocator>& lhs, const FlatMap<Key, Value, Compare, Allocator>& rhs) {
+    return lhs.Keys() == rhs.Keys() && lhs.Values() == rhs.Values();
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool operator!=(const FlatMap<Key, Value, Compare, Allocator>& lhs, const FlatMap<Key, Value, Compare, Allocator>& rhs) {
+    return !(lhs == rhs);
+}
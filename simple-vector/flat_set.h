@@ -0,0 +1,328 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "hardening.h"
+#include "relocation.h"
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+#include "uninitialized.h"
+
+// Возвращает первый элемент отсортированного массива first[0, count), не меньший
+// key, или first + count. Вместо ветвления на каждом шаге выбирается одна из двух
+// половин, и компилятор может заменить выбор условной пересылкой: непредсказуемых
+// переходов нет, и число шагов зависит только от count
+template <typename Type, typename Compare>
+const Type* BranchlessLowerBound(const Type* first, size_t count, const Type& key, Compare& comp) {
+    if (count == 0) {
+        return first;
+    }
+    while (count > 1) {
+        const size_t half = count / 2;
+        first = comp(first[half], key) ? first + half : first;
+        count -= half;
+    }
+    return first + (comp(*first, key) ? 1 : 0);
+}
+
+// Сортирует элементы items и удаляет эквивалентные, оставляя первый из них
+template <typename Type, typename Allocator, typename GrowthPolicy, typename Compare>
+void SortUnique(SimpleVector<Type, Allocator, GrowthPolicy>& items, Compare& comp) {
+    std::stable_sort(items.begin(), items.end(), comp);
+    const auto new_end = std::unique(items.begin(), items.end(), [&comp](const Type& lhs, const Type& rhs) {
+        return !comp(lhs, rhs);
+    });
+    items.Erase(new_end, items.end());
+}
+
+// Создаёт в неинициализированной памяти dest count элементов слиянием двух
+// массивов: from_existing(existing, incoming) решает, берётся ли следующий элемент
+// из existing или из incoming. Элементы incoming перемещаются, а элементы existing
+// переносятся как при перевыделении: копируются, если перемещение может бросить
+// исключение, поэтому при исключении existing остаётся прежним
+template <typename Allocator, typename Type, typename Source>
+void UninitializedMergeN(Allocator& alloc, Type* dest, size_t count, Type* existing, Type* incoming,
+                         Source from_existing) {
+    UninitializedConstructN(alloc, dest, count, [&](Allocator& a, Type* ptr) {
+        if (from_existing(existing, incoming)) {
+            if constexpr (IsRelocatedByMoveV<Type>) {
+                Construct(a, ptr, std::move(*existing++));
+            } else {
+                Construct(a, ptr, *existing++);
+            }
+        } else {
+            Construct(a, ptr, std::move(*incoming++));
+        }
+    });
+}
+
+// Упорядоченное множество уникальных элементов в отсортированном SimpleVector.
+// Поиск — двоичный по непрерывному массиву, поэтому небольшие таблицы занимают
+// несколько строк кэша вместо узлов std::set, разбросанных по куче. Вставка
+// и удаление одного элемента сдвигают хвост за O(size): множество выгоднее
+// строить сразу из всех элементов или добавлять их пачками через InsertRange.
+// Итераторы и ссылки на элементы действительны до изменения множества
+template <typename Key, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>>
+class FlatSet {
+public:
+    using Vector = SimpleVector<Key, Allocator>;
+    using ConstIterator = const Key*;
+
+    FlatSet() = default;
+
+    // Создаёт множество из элементов диапазона [first, last): элементы сортируются
+    // один раз, а повторы удаляются
+    template <typename InputIt, EnableIfInputIterator<InputIt> = 0>
+    FlatSet(InputIt first, InputIt last, const Compare& comp = Compare())
+        : comp_(comp)
+        , items_(first, last) {
+        SortUnique(items_, comp_);
+    }
+
+    FlatSet(std::initializer_list<Key> init, const Compare& comp = Compare())
+        : FlatSet(init.begin(), init.end(), comp) {
+    }
+
+    // Забирает элементы вектора items без копирования и сортирует их на месте
+    explicit FlatSet(Vector&& items, const Compare& comp = Compare())
+        : comp_(comp)
+        , items_(std::move(items)) {
+        SortUnique(items_, comp_);
+    }
+
+    size_t GetSize() const noexcept {
+        return items_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept {
+        return items_.IsEmpty();
+    }
+
+    const Key* Data() const noexcept {
+        return items_.Data();
+    }
+
+    ConstIterator begin() const noexcept {
+        return Data();
+    }
+
+    ConstIterator end() const noexcept {
+        return Data() + GetSize();
+    }
+
+    // Возвращает отсортированные элементы
+    SimpleVectorView<const Key> GetView() const noexcept {
+        return SimpleVectorView<const Key>(Data(), GetSize());
+    }
+
+    // Возвращает первый элемент, не меньший key, или end()
+    ConstIterator LowerBound(const Key& key) const {
+        return BranchlessLowerBound(Data(), GetSize(), key, comp_);
+    }
+
+    // Возвращает элемент, эквивалентный key, или end()
+    ConstIterator Find(const Key& key) const {
+        const ConstIterator it = LowerBound(key);
+        return it != end() && !comp_(key, *it) ? it : end();
+    }
+
+    bool Contains(const Key& key) const {
+        return Find(key) != end();
+    }
+
+    // Вставляет key, если эквивалентного элемента ещё нет. Возвращает, вставлен ли он
+    bool Insert(const Key& key) {
+        return InsertUnique(key);
+    }
+
+    bool Insert(Key&& key) {
+        return InsertUnique(std::move(key));
+    }
+
+    // Вставляет элементы диапазона [first, last), которых ещё нет в множестве.
+    // Диапазон сортируется отдельно и сливается с множеством за один проход,
+    // поэтому вставка m элементов стоит O(m log m + size), а не O(m * size).
+    // Если все новые элементы больше имеющихся, они просто дописываются в конец
+    template <typename InputIt, EnableIfInputIterator<InputIt> = 0>
+    void InsertRange(InputIt first, InputIt last) {
+        Vector incoming(first, last, items_.GetAllocator());
+        SortUnique(incoming, comp_);
+        const Key* const existing_end = Data() + GetSize();
+        incoming.EraseIf([this, cursor = Data(), existing_end](const Key& key) mutable {
+            cursor = std::lower_bound(cursor, existing_end, key, comp_);
+            return cursor != existing_end && !comp_(key, *cursor);
+        });
+        if (incoming.IsEmpty()) {
+            return;
+        }
+        if (IsEmpty() || comp_(existing_end[-1], incoming[0])) {
+            items_.Insert(items_.cend(), std::make_move_iterator(incoming.Data()),
+                          std::make_move_iterator(incoming.Data() + incoming.GetSize()));
+            return;
+        }
+        Vector merged(items_.GetAllocator());
+        Key* const incoming_end = incoming.Data() + incoming.GetSize();
+        merged.AppendConstructed(GetSize() + incoming.GetSize(), [&](Allocator& alloc, Key* dest, size_t count) {
+            UninitializedMergeN(alloc, dest, count, items_.Data(), incoming.Data(),
+                                [&](const Key* existing, const Key* next) {
+                                    return next == incoming_end || (existing != existing_end && comp_(*existing, *next));
+                                });
+        });
+        items_.swap(merged);
+    }
+
+    // Удаляет элемент, эквивалентный key. Возвращает, был ли он
+    bool Erase(const Key& key) {
+        const ConstIterator it = Find(key);
+        if (it == end()) {
+            return false;
+        }
+        items_.Erase(items_.cbegin() + (it - begin()));
+        return true;
+    }
+
+    // Удаляет элементы, для которых pred истинен. Возвращает количество удалённых
+    template <typename Predicate>
+    size_t EraseIf(Predicate pred) {
+        return items_.EraseIf(pred);
+    }
+
+    void Clear() noexcept {
+        items_.Clear();
+    }
+
+    void Reserve(size_t new_capacity) {
+        items_.Reserve(new_capacity);
+    }
+
+    void ShrinkToFit() {
+        items_.ShrinkToFit();
+    }
+
+    VectorMemoryUsage MemoryUsage() const noexcept {
+        return items_.MemoryUsage();
+    }
+
+    void swap(FlatSet& other) noexcept {
+        std::swap(comp_, other.comp_);
+        items_.swap(other.items_);
+    }
+
+private:
+    Compare comp_;
+    Vector items_;
+
+    template <typename Arg>
+    bool InsertUnique(Arg&& key) {
+        const ConstIterator it = LowerBound(key);
+        if (it != end() && !comp_(key, *it)) {
+            return false;
+        }
+        items_.Insert(items_.cbegin() + (it - begin()), std::forward<Arg>(key));
+        return true;
+    }
+};
+
+template <typename Key, typename Compare, typename Allocator>
+void swap(FlatSet<Key, Compare, Allocator>& lhs, FlatSet<Key, Compare, Allocator>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+template <typename Key, typename Compare, typename Allocator>
+bool operator==(const FlatSet<Key, Compare, Allocator>& lhs, const FlatSet<Key, Compare, Allocator>& rhs) {
+    return lhs.GetView() == rhs.GetView();
+}
+
+template <typename Key, typename Compare, typename Allocator>
+bool operator!=(const FlatSet<Key, Compare, Allocator>& lhs, const FlatSet<Key, Compare, Allocator>& rhs) {
+    return !(lhs == rhs);
+}
+
+// Неизменяемая копия отсортированных элементов в порядке Эйтцингера: корень
+// дерева поиска, затем оба его потомка, затем четыре внука и так далее.
+// Первые шаги любого поиска читают одни и те же соседние элементы, которые
+// остаются в кэше, а потомки узла k лежат рядом (2k и 2k + 1), поэтому их можно
+// загрузить заранее, на несколько уровней вперёд. Для горячих путей чтения
+// большой таблицы это быстрее двоичного поиска по отсортированному массиву.
+// Порядок элементов не сохраняется, поэтому множество строится один раз,
+// например из FlatSet, и не меняется
+template <typename Key, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>>
+class EytzingerSet {
+public:
+    EytzingerSet() = default;
+
+    // Строит дерево из отсортированных уникальных элементов sorted
+    explicit EytzingerSet(SimpleVectorView<const Key> sorted, const Compare& comp = Compare())
+        : comp_(comp) {
+        tree_.Reserve(sorted.GetSize());
+        SimpleVector<size_t> order(sorted.GetSize());
+        size_t next = 0;
+        FillOrder(order, 1, next);
+        for (size_t i = 0; i < order.GetSize(); ++i) {
+            tree_.PushBack(sorted[order[i]]);
+        }
+    }
+
+    explicit EytzingerSet(const FlatSet<Key, Compare, Allocator>& set, const Compare& comp = Compare())
+        : EytzingerSet(set.GetView(), comp) {
+    }
+
+    size_t GetSize() const noexcept {
+        return tree_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept {
+        return tree_.IsEmpty();
+    }
+
+    // Возвращает первый элемент, не меньший key, или nullptr
+    const Key* LowerBound(const Key& key) const {
+        const Key* const tree = tree_.Data();
+        const size_t size = tree_.GetSize();
+        // Узлы нумеруются с единицы: узел k хранится в tree[k - 1]
+        size_t k = 1;
+        while (k <= size) {
+#if defined(__GNUC__)
+            // Через четыре уровня потомки узла k начинаются с 16k
+            __builtin_prefetch(tree + std::min(16 * k, size) - 1);
+#endif
+            k = 2 * k + (comp_(tree[k - 1], key) ? 1 : 0);
+        }
+        // Последний поворот налево ведёт к ответу: отбрасываем повороты направо после него
+        while ((k & 1) != 0) {
+            k >>= 1;
+        }
+        k >>= 1;
+        return k == 0 ? nullptr : tree + k - 1;
+    }
+
+    bool Contains(const Key& key) const {
+        const Key* const found = LowerBound(key);
+        return found != nullptr && !comp_(key, *found);
+    }
+
+    VectorMemoryUsage MemoryUsage() const noexcept {
+        return tree_.MemoryUsage();
+    }
+
+private:
+    Compare comp_;
+    SimpleVector<Key, Allocator> tree_;
+
+    // Обходит дерево в симметричном порядке и записывает в order[k - 1] номер
+    // отсортированного элемента для узла k
+    static void FillOrder(SimpleVector<size_t>& order, size_t k, size_t& next) {
+        if (k > order.GetSize()) {
+            return;
+        }
+        FillOrder(order, 2 * k, next);
+        order[k - 1] = next++;
+        FillOrder(order, 2 * k + 1, next);
+    }
+};
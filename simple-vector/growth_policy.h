@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+// Политики роста вместимости вектора.
+// Политика — это тип со статическим методом
+//     static size_t NextCapacity(size_t capacity, size_t required, size_t element_size);
+// который по текущей вместимости capacity возвращает новую вместимость
+// не меньше required. element_size — размер элемента в байтах, он нужен
+// политикам, работающим с размером выделяемого блока.
+// Чтобы вектор можно было заполнять во время компиляции, метод должен быть constexpr
+
+// Вычисляет capacity * numerator / denominator без переполнения
+constexpr size_t ScaleCapacity(size_t capacity, size_t numerator, size_t denominator) noexcept {
+    const size_t max = std::numeric_limits<size_t>::max();
+    if (capacity > max / numerator) {
+        return max;
+    }
+    return capacity * numerator / denominator;
+}
+
+// Округляет value вверх до кратного granularity без переполнения
+constexpr size_t RoundUpCapacity(size_t value, size_t granularity) noexcept {
+    const size_t remainder = value % granularity;
+    if (remainder == 0) {
+        return value;
+    }
+    const size_t step = granularity - remainder;
+    return value > std::numeric_limits<size_t>::max() - step ? value : value + step;
+}
+
+// Удваивает вместимость. Для пустого вектора вместимость становится равной required
+struct DoublingGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        return std::max(required, ScaleCapacity(capacity, 2, 1));
+    }
+};
+
+// Увеличивает вместимость в полтора раза. При таком росте суммарный размер
+// освобождённых ранее блоков со временем превышает размер нового, и аллокатор
+// может переиспользовать эту память
+struct GoldenGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        return std::max(required, ScaleCapacity(capacity, 3, 2));
+    }
+};
+
+// Ограничивает шаг роста политики Base: за один раз вместимость увеличивается
+// не больше чем на MaxStepBytes байт (но не меньше, чем до required).
+// Нужна для очень больших векторов, чтобы не выделять почти вдвое больше памяти, чем нужно
+template <size_t MaxStepBytes, typename Base = DoublingGrowth>
+struct CappedGrowth {
+    static_assert(MaxStepBytes > 0, "growth step must be positive");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t proposed = Base::NextCapacity(capacity, required, element_size);
+        const size_t max_step = std::max<size_t>(MaxStepBytes / element_size, 1);
+        if (proposed - capacity <= max_step) {
+            return proposed;
+        }
+        return std::max(required, capacity + max_step);
+    }
+};
+
+// Округляет вместимость, предложенную политикой Base, вверх так, чтобы блок
+// занимал целый класс размеров аллокатора: небольшие блоки — до степени двойки,
+// блоки больше страницы — до целого числа страниц PageSize. Этот запас
+// аллокатор всё равно выделил бы, а так он становится вместимостью вектора
+template <typename Base = DoublingGrowth, size_t PageSize = 4096>
+struct AllocationRoundingGrowth {
+    static_assert(PageSize > 0 && (PageSize & (PageSize - 1)) == 0, "page size must be a power of two");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t proposed = Base::NextCapacity(capacity, required, element_size);
+        if (proposed > std::numeric_limits<size_t>::max() / element_size) {
+            return proposed;
+        }
+        const size_t bytes = proposed * element_size;
+        size_t rounded = 16;
+        if (bytes > PageSize) {
+            rounded = RoundUpCapacity(bytes, PageSize);
+        } else {
+            while (rounded < bytes) {
+                rounded *= 2;
+            }
+        }
+        return std::max(proposed, rounded / element_size);
+    }
+};
+
+// Политика может также уменьшать вместимость, когда элементов становится мало.
+// Для этого она объявляет статический метод
+//     static size_t ShrinkCapacity(size_t size, size_t capacity, size_t element_size);
+// возвращающий новую вместимость не меньше size (или capacity, если уменьшать не нужно).
+// Вектор вызывает его после удаления элементов
+template <typename Policy, typename = void>
+struct HasShrinkCapacity : std::false_type {
+};
+
+template <typename Policy>
+struct HasShrinkCapacity<Policy, std::void_t<decltype(Policy::ShrinkCapacity(size_t{}, size_t{}, size_t{}))>>
+    : std::true_type {
+};
+
+// Растёт по политике Base и освобождает память с гистерезисом: когда размер
+// становится меньше Numerator / Denominator вместимости, вместимость уменьшается
+// до удвоенного размера. Запас вдвое не даёт вектору перевыделять память на каждой
+// паре удаление—вставка у границы
+template <size_t Numerator = 1, size_t Denominator = 4, typename Base = DoublingGrowth>
+struct HysteresisGrowth {
+    static_assert(Numerator > 0 && Numerator * 2 <= Denominator,
+                  "shrink threshold must be at most half of the capacity");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        return Base::NextCapacity(capacity, required, element_size);
+    }
+
+    static constexpr size_t ShrinkCapacity(size_t size, size_t capacity, size_t /*element_size*/) noexcept {
+        if (ScaleCapacity(size, Denominator, 1) >= ScaleCapacity(capacity, Numerator, 1)) {
+            return capacity;
+        }
+        return size * 2;
+    }
+};
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <type_traits>
+
+// Режим с проверками включается макросом SIMPLE_VECTOR_HARDENED. В нём
+// SIMPLE_VECTOR_CHECK проверяет условие и в сборке с NDEBUG, а итераторы
+// SimpleVector становятся CheckedIterator: они помнят поколение вектора и
+// обнаруживают использование после перевыделения памяти, вставки и удаления.
+// Нарушение печатает сообщение и аварийно завершает программу.
+// Без SIMPLE_VECTOR_HARDENED проверки — обычные assert, а итераторы — указатели
+
+// Сообщает о нарушении и завершает программу
+[[noreturn]] inline void HardenedCheckFailed(const char* message) noexcept {
+    std::fprintf(stderr, "SimpleVector hardened check failed: %s\n", message);
+    std::abort();
+}
+
+constexpr void HardenedCheck(bool condition, const char* message) noexcept {
+    if (!condition) {
+        HardenedCheckFailed(message);
+    }
+}
+
+#ifdef SIMPLE_VECTOR_HARDENED
+#define SIMPLE_VECTOR_CHECK(condition, message) HardenedCheck(static_cast<bool>(condition), message)
+#else
+#define SIMPLE_VECTOR_CHECK(condition, message) assert((condition) && message)
+#endif
+
+// Итератор произвольного доступа по элементам Owner с проверками.
+// Owner предоставляет Data(), GetSize() и GetGeneration(); поколение растёт при
+// каждой операции, делающей итераторы недействительными. Итератор хранит
+// указатель на владельца, поэтому не должен переживать вектор
+template <typename Owner, typename Type>
+class CheckedIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_cv_t<Type>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Type*;
+    using reference = Type&;
+
+    CheckedIterator() noexcept = default;
+
+    constexpr CheckedIterator(const Owner* owner, Type* ptr) noexcept
+        : owner_(owner)
+        , ptr_(ptr)
+        , generation_(owner->GetGeneration()) {
+    }
+
+    // Итератор изменяемых элементов преобразуется в итератор константных
+    template <typename T = Type, std::enable_if_t<std::is_const_v<T>, int> = 0>
+    constexpr CheckedIterator(const CheckedIterator<Owner, std::remove_const_t<Type>>& other) noexcept
+        : owner_(other.owner_)
+        , ptr_(other.ptr_)
+        , generation_(other.generation_) {
+    }
+
+    // Возвращает указатель на элемент без проверок
+    constexpr Type* Get() const noexcept {
+        return ptr_;
+    }
+
+    constexpr reference operator*() const noexcept {
+        CheckDereferenceable(0);
+        return *ptr_;
+    }
+
+    constexpr pointer operator->() const noexcept {
+        CheckDereferenceable(0);
+        return ptr_;
+    }
+
+    constexpr reference operator[](difference_type offset) const noexcept {
+        CheckDereferenceable(offset);
+        return ptr_[offset];
+    }
+
+    constexpr CheckedIterator& operator+=(difference_type offset) noexcept {
+        CheckValid();
+        const difference_type position = ptr_ - owner_->Data() + offset;
+        HardenedCheck(position >= 0 && static_cast<size_t>(position) <= owner_->GetSize(),
+                      "iterator moved out of range");
+        ptr_ += offset;
+        return *this;
+    }
+
+    constexpr CheckedIterator& operator-=(difference_type offset) noexcept {
+        return *this += -offset;
+    }
+
+    constexpr CheckedIterator& operator++() noexcept {
+        return *this += 1;
+    }
+
+    constexpr CheckedIterator operator++(int) noexcept {
+        CheckedIterator old = *this;
+        ++*this;
+        return old;
+    }
+
+    constexpr CheckedIterator& operator--() noexcept {
+        return *this -= 1;
+    }
+
+    constexpr CheckedIterator operator--(int) noexcept {
+        CheckedIterator old = *this;
+        --*this;
+        return old;
+    }
+
+    friend constexpr CheckedIterator operator+(CheckedIterator it, difference_type offset) noexcept {
+        return it += offset;
+    }
+
+    friend constexpr CheckedIterator operator+(difference_type offset, CheckedIterator it) noexcept {
+        return it += offset;
+    }
+
+    friend constexpr CheckedIterator operator-(CheckedIterator it, difference_type offset) noexcept {
+        return it -= offset;
+    }
+
+    friend constexpr difference_type operator-(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        CheckComparable(lhs, rhs);
+        return lhs.ptr_ - rhs.ptr_;
+    }
+
+    friend constexpr bool operator==(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        CheckComparable(lhs, rhs);
+        return lhs.ptr_ == rhs.ptr_;
+    }
+
+    friend constexpr bool operator!=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+    friend constexpr bool operator<(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        CheckComparable(lhs, rhs);
+        return lhs.ptr_ < rhs.ptr_;
+    }
+
+    friend constexpr bool operator<=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return !(rhs < lhs);
+    }
+
+    friend constexpr bool operator>(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return rhs < lhs;
+    }
+
+    friend constexpr bool operator>=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return !(lhs < rhs);
+    }
+
+private:
+    template <typename, typename>
+    friend class CheckedIterator;
+
+    const Owner* owner_ = nullptr;
+    Type* ptr_ = nullptr;
+    uint64_t generation_ = 0;
+
+    constexpr void CheckValid() const noexcept {
+        HardenedCheck(owner_ != nullptr, "singular iterator");
+        HardenedCheck(generation_ == owner_->GetGeneration(), "iterator invalidated by reallocation, Insert or Erase");
+    }
+
+    constexpr void CheckDereferenceable(difference_type offset) const noexcept {
+        CheckValid();
+        const difference_type position = ptr_ - owner_->Data() + offset;
+        HardenedCheck(position >= 0 && static_cast<size_t>(position) < owner_->GetSize(),
+                      "dereferencing iterator out of range");
+    }
+
+    static constexpr void CheckComparable(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        lhs.CheckValid();
+        rhs.CheckValid();
+        HardenedCheck(lhs.owner_ == rhs.owner_, "comparing iterators of different vectors");
+    }
+};
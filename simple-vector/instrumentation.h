@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "growth_policy.h"
+
+// Инструментирование SimpleVector: события выделения памяти, переноса элементов
+// и сдвига хвоста при вставке и удалении. Включается политикой роста с
+// дополнительным статическим методом
+//     static void OnVectorEvent(const VectorEvent& event) noexcept;
+// (например, InstrumentedGrowth). Для остальных политик вектор не хранит ничего
+// лишнего и не вызывает никакого кода
+
+// Место в коде, которым помечен вектор. Создаётся макросом SIMPLE_VECTOR_CALL_SITE()
+// и живёт до конца программы, поэтому сравнивается по адресу
+struct VectorCallSite {
+    const char* file = nullptr;
+    unsigned line = 0;
+};
+
+// Возвращает указатель на статический VectorCallSite для строки, где стоит макрос
+#define SIMPLE_VECTOR_CALL_SITE()                                               \
+    ([]() noexcept -> const VectorCallSite* {                                   \
+        static constexpr VectorCallSite simple_vector_call_site{__FILE__, __LINE__}; \
+        return &simple_vector_call_site;                                        \
+    }())
+
+enum class VectorEventKind {
+    // Вектор без памяти получил первый буфер
+    kAllocate,
+    // Элементы перенесены в новый буфер (или память освобождена)
+    kReallocate,
+    // Хвост вектора сдвинут при вставке или удалении без перевыделения
+    kShift,
+};
+
+struct VectorEvent {
+    VectorEventKind kind = VectorEventKind::kAllocate;
+    // Место, которым помечен вектор, или nullptr
+    const VectorCallSite* site = nullptr;
+    const void* vector = nullptr;
+    size_t element_size = 0;
+    size_t old_capacity = 0;
+    size_t new_capacity = 0;
+    // Количество перенесённых (kReallocate) или сдвинутых (kShift) элементов
+    size_t elements = 0;
+
+    size_t GetBytes() const noexcept {
+        return elements * element_size;
+    }
+};
+
+template <typename Policy, typename = void>
+struct HasVectorEventHook : std::false_type {
+};
+
+template <typename Policy>
+struct HasVectorEventHook<Policy, std::void_t<decltype(Policy::OnVectorEvent(std::declval<const VectorEvent&>()))>>
+    : std::true_type {
+};
+
+// Растёт по политике Base и передаёт события вектора в Instrumentation::OnEvent.
+// Обработчик не должен выбрасывать исключения: события приходят и из noexcept-методов
+template <typename Instrumentation, typename Base = DoublingGrowth>
+struct InstrumentedGrowth : Base {
+    static void OnVectorEvent(const VectorEvent& event) noexcept {
+        Instrumentation::OnEvent(event);
+    }
+};
+
+// Хранит место, которым помечен вектор. Для неинструментированных векторов
+// пустой базовый класс, не увеличивающий размер вектора.
+// Место относится к объекту, а не к элементам, поэтому не передаётся
+// при копировании, перемещении и обмене
+template <bool Enabled>
+class VectorCallSiteHolder {
+public:
+    constexpr void SetCallSite(const VectorCallSite* /*site*/) noexcept {
+    }
+
+    constexpr const VectorCallSite* GetCallSite() const noexcept {
+        return nullptr;
+    }
+};
+
+template <>
+class VectorCallSiteHolder<true> {
+public:
+    VectorCallSiteHolder() noexcept = default;
+
+    constexpr VectorCallSiteHolder(const VectorCallSiteHolder&) noexcept {
+    }
+
+    constexpr VectorCallSiteHolder& operator=(const VectorCallSiteHolder&) noexcept {
+        return *this;
+    }
+
+    constexpr void SetCallSite(const VectorCallSite* site) noexcept {
+        site_ = site;
+    }
+
+    constexpr const VectorCallSite* GetCallSite() const noexcept {
+        return site_;
+    }
+
+private:
+    const VectorCallSite* site_ = nullptr;
+};
+
+// Сводка событий векторов, помеченных одним местом (site == nullptr — непомеченные)
+struct VectorCallSiteStats {
+    const VectorCallSite* site = nullptr;
+    // Сколько раз вектор получал новый буфер
+    size_t allocations = 0;
+    // Сколько раз элементы переносились в новый буфер
+    size_t reallocations = 0;
+    size_t bytes_moved = 0;
+    size_t elements_shifted = 0;
+    size_t peak_capacity = 0;
+};
+
+// Собирает события по местам, которыми помечены векторы, и передаёт каждое
+// событие в обработчик, заданный SetHook (например, в систему трассировки).
+// Методы потокобезопасны
+class CallSiteStatsInstrumentation {
+public:
+    using Hook = void (*)(const VectorEvent& event) noexcept;
+
+    static void OnEvent(const VectorEvent& event) noexcept {
+        Registry& registry = GetRegistry();
+        try {
+            std::lock_guard lock(registry.mutex);
+            VectorCallSiteStats& stats = registry.stats[event.site];
+            stats.site = event.site;
+            if (event.kind == VectorEventKind::kShift) {
+                stats.elements_shifted += event.elements;
+            } else {
+                if (event.new_capacity > 0) {
+                    ++stats.allocations;
+                }
+                if (event.kind == VectorEventKind::kReallocate) {
+                    ++stats.reallocations;
+                    stats.bytes_moved += event.GetBytes();
+                }
+                stats.peak_capacity = std::max(stats.peak_capacity, event.new_capacity);
+            }
+        } catch (...) {
+            // Статистика не должна ломать работу вектора: событие теряется
+        }
+        if (const Hook hook = registry.hook.load(std::memory_order_acquire)) {
+            hook(event);
+        }
+    }
+
+    // Задаёт обработчик, получающий каждое событие; nullptr отключает его
+    static void SetHook(Hook hook) noexcept {
+        GetRegistry().hook.store(hook, std::memory_order_release);
+    }
+
+    // Возвращает сводки по местам, начиная с мест с наибольшим числом переносов —
+    // первыми оказываются векторы, которым не хватает Reserve
+    static std::vector<VectorCallSiteStats> GetStats() {
+        Registry& registry = GetRegistry();
+        std::vector<VectorCallSiteStats> result;
+        {
+            std::lock_guard lock(registry.mutex);
+            result.reserve(registry.stats.size());
+            for (const auto& [site, stats] : registry.stats) {
+                result.push_back(stats);
+            }
+        }
+        std::stable_sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.reallocations > rhs.reallocations;
+        });
+        return result;
+    }
+
+    static void Reset() {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        registry.stats.clear();
+    }
+
+private:
+    struct Registry {
+        std::mutex mutex;
+        std::map<const VectorCallSite*, VectorCallSiteStats> stats;
+        std::atomic<Hook> hook{nullptr};
+    };
+
+    static Registry& GetRegistry() noexcept {
+        static Registry registry;
+        return registry;
+    }
+};
@@ -0,0 +1,204 @@
+// Бенчмарки распределения задержек отдельных операций SimpleVector на Google
+// Benchmark. В отличие от benchmark.cpp, который измеряет пропускную способность,
+// здесь каждая операция измеряется отдельно, а результаты собираются в гистограмму,
+// чтобы видеть хвост распределения: операции, попавшие на перевыделение, и сдвиги.
+// Глобальный operator new подменён (allocation_counter.cpp), поэтому в отчёте есть
+// и число выделений памяти на операцию.
+// Сборка и запуск:
+//     g++ -std=c++17 -O2 -DNDEBUG latency_benchmark.cpp allocation_counter.cpp -lbenchmark -lpthread -o latency_benchmark
+//     ./latency_benchmark --benchmark_out=latency.json --benchmark_out_format=json
+
+#include "allocation_counter.h"
+#include "background_growth_vector.h"
+#include "simple_vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+// Гистограмма задержек в наносекундах в духе HdrHistogram: значения до
+// 2 * kSubBucketCount хранятся точно, а каждый следующий интервал [2^k, 2^(k+1))
+// делится на kSubBucketCount равных частей. Относительная погрешность
+// перцентилей поэтому не больше 1 / kSubBucketCount при фиксированной памяти
+class LatencyHistogram {
+public:
+    void Record(uint64_t value) noexcept {
+        ++counts_[GetBucketIndex(value)];
+        ++count_;
+        max_ = std::max(max_, value);
+    }
+
+    uint64_t GetCount() const noexcept {
+        return count_;
+    }
+
+    uint64_t GetMax() const noexcept {
+        return max_;
+    }
+
+    // Возвращает наибольшее значение интервала, в который попадает перцентиль
+    // percentile (от 0 до 100), но не больше максимума
+    uint64_t GetPercentile(double percentile) const noexcept {
+        if (count_ == 0) {
+            return 0;
+        }
+        const uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(count_ - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t index = 0; index < kBucketCount; ++index) {
+            seen += counts_[index];
+            if (seen >= rank) {
+                return std::min(GetBucketUpperBound(index), max_);
+            }
+        }
+        return max_;
+    }
+
+private:
+    static constexpr size_t kSubBucketBits = 5;
+    static constexpr uint64_t kSubBucketCount = uint64_t{1} << kSubBucketBits;
+    static constexpr size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBucketCount;
+
+    array<uint64_t, kBucketCount> counts_{};
+    uint64_t count_ = 0;
+    uint64_t max_ = 0;
+
+    // Значения из [2^(k + kSubBucketBits), 2^(k + kSubBucketBits + 1)) лежат в
+    // интервалах шириной 2^k с номерами (k + 1) * kSubBucketCount + часть
+    static size_t GetBucketIndex(uint64_t value) noexcept {
+        size_t shift = 0;
+        while ((value >> shift) >= 2 * kSubBucketCount) {
+            ++shift;
+        }
+        if (shift == 0) {
+            return static_cast<size_t>(value);
+        }
+        return static_cast<size_t>((shift + 1) * kSubBucketCount + (value >> shift) - kSubBucketCount);
+    }
+
+    static uint64_t GetBucketUpperBound(size_t index) noexcept {
+        if (index < 2 * kSubBucketCount) {
+            return index;
+        }
+        const size_t shift = index / kSubBucketCount - 1;
+        const uint64_t sub_bucket = index % kSubBucketCount + kSubBucketCount;
+        return ((sub_bucket + 1) << shift) - 1;
+    }
+};
+
+// Задержки измеренных операций и память, выделенная внутри них
+struct OperationStats {
+    LatencyHistogram latency;
+    AllocationStats allocated;
+};
+
+// Выполняет operation, добавляя её задержку и выделения памяти в stats
+template <typename Operation>
+void Measure(OperationStats& stats, Operation&& operation) {
+    const AllocationScope scope;
+    const auto start = chrono::steady_clock::now();
+    operation();
+    const auto elapsed = chrono::steady_clock::now() - start;
+    stats.latency.Record(static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(elapsed).count()));
+    stats.allocated.allocations += scope.GetAllocations();
+    stats.allocated.bytes += scope.GetBytes();
+}
+
+// Переносит перцентили, максимум и число выделений памяти на операцию в отчёт
+void ReportLatency(benchmark::State& state, const OperationStats& stats) {
+    const LatencyHistogram& latency = stats.latency;
+    state.counters["p50_ns"] = static_cast<double>(latency.GetPercentile(50.0));
+    state.counters["p99_ns"] = static_cast<double>(latency.GetPercentile(99.0));
+    state.counters["p99.9_ns"] = static_cast<double>(latency.GetPercentile(99.9));
+    state.counters["max_ns"] = static_cast<double>(latency.GetMax());
+    const double operations = static_cast<double>(latency.GetCount());
+    state.counters["allocs_per_op"] = static_cast<double>(stats.allocated.allocations) / operations;
+    state.counters["bytes_per_op"] = static_cast<double>(stats.allocated.bytes) / operations;
+    state.SetItemsProcessed(static_cast<int64_t>(latency.GetCount()));
+}
+
+template <typename Type>
+Type MakeValue(size_t i) {
+    if constexpr (is_same_v<Type, string>) {
+        return "latency benchmark string number "s + to_string(i);
+    } else {
+        return static_cast<Type>(i);
+    }
+}
+
+// Заполняет вектор без Reserve: хвост распределения — добавления, попавшие
+// на перевыделение
+template <typename Vector>
+void BenchPushBackLatency(benchmark::State& state) {
+    using Type = remove_reference_t<decltype(declval<Vector&>()[0])>;
+    const size_t size = static_cast<size_t>(state.range(0));
+    OperationStats stats;
+    for (auto _ : state) {
+        Vector v;
+        for (size_t i = 0; i < size; ++i) {
+            Type value = MakeValue<Type>(i);
+            Measure(stats, [&] {
+                v.PushBack(std::move(value));
+            });
+        }
+        benchmark::DoNotOptimize(v.Data());
+    }
+    ReportLatency(state, stats);
+}
+
+// Вставляет элементы в середину растущего вектора: каждая вставка сдвигает
+// половину хвоста, а некоторые ещё и перевыделяют память
+template <typename Type>
+void BenchInsertLatency(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    OperationStats stats;
+    for (auto _ : state) {
+        SimpleVector<Type> v;
+        for (size_t i = 0; i < size; ++i) {
+            Type value = MakeValue<Type>(i);
+            Measure(stats, [&] {
+                v.Insert(v.cbegin() + v.GetSize() / 2, std::move(value));
+            });
+        }
+        benchmark::DoNotOptimize(v.Data());
+    }
+    ReportLatency(state, stats);
+}
+
+// Удаляет элементы из середины, пока вектор не опустеет
+template <typename Type>
+void BenchEraseLatency(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    OperationStats stats;
+    for (auto _ : state) {
+        state.PauseTiming();
+        SimpleVector<Type> v;
+        v.Reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            v.PushBack(MakeValue<Type>(i));
+        }
+        state.ResumeTiming();
+        while (!v.IsEmpty()) {
+            Measure(stats, [&] {
+                v.Erase(v.cbegin() + v.GetSize() / 2);
+            });
+        }
+        benchmark::DoNotOptimize(v.Data());
+    }
+    ReportLatency(state, stats);
+}
+
+BENCHMARK_TEMPLATE(BenchPushBackLatency, SimpleVector<int>)->RangeMultiplier(16)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(BenchPushBackLatency, SimpleVector<string>)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BenchPushBackLatency, BackgroundGrowthVector<int>)->RangeMultiplier(16)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(BenchInsertLatency, int)->RangeMultiplier(8)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BenchInsertLatency, string)->RangeMultiplier(8)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BenchEraseLatency, int)->RangeMultiplier(8)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BenchEraseLatency, string)->RangeMultiplier(8)->Range(1 << 10, 1 << 16);
+
+BENCHMARK_MAIN();
@@ -1,35 +1,232 @@
+#include "aligned_allocator.h"
+#include "allocation_counter.h"
+#include "background_growth_vector.h"
+#include "buffer_pool.h"
+#include "concurrent_simple_vector.h"
+#include "flat_map.h"
+#include "flat_set.h"
+#include "instrumentation.h"
+#include "mapped_simple_vector.h"
+#include "packed_simple_vector.h"
+#include "realloc_allocator.h"
+#include "segmented_vector.h"
+#include "serialization.h"
+#include "shared_simple_vector.h"
 #include "simple_vector.h"
+#include "simple_vector_algorithms.h"
+#include "simple_vector_view.h"
+#include "small_simple_vector.h"
+#include "soa_vector.h"
+#include "test_types.h"
 
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <csignal>
+#include <filesystem>
 #include <iostream>
+#include <limits>
+#include <memory_resource>
+#include <list>
 #include <numeric>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace std;
 
-class X {
+// Считает количество живых объектов, чтобы проверять, что вектор
+// не создаёт лишних элементов в запасе вместимости.
+// Счётчик атомарный, потому что параллельные алгоритмы создают объекты в разных потоках
+class Counted {
 public:
-    X()
-        : X(5) {
+    explicit Counted(int value)
+        : value_(value) {
+        ++alive;
+    }
+    Counted(const Counted& other)
+        : value_(other.value_) {
+        ++alive;
+    }
+    Counted(Counted&& other) noexcept
+        : value_(exchange(other.value_, 0)) {
+        ++alive;
+    }
+    Counted& operator=(const Counted&) = default;
+    Counted& operator=(Counted&& other) noexcept {
+        value_ = exchange(other.value_, 0);
+        return *this;
     }
-    X(size_t num)
-        : x_(num) {
+    ~Counted() {
+        --alive;
+    }
+    int GetValue() const {
+        return value_;
+    }
+
+    inline static atomic<int> alive = 0;
+
+private:
+    int value_;
+};
+
+// Владеет объектом в куче и не хранит ссылок на себя, поэтому его можно
+// переносить побайтово
+class Boxed {
+public:
+    explicit Boxed(int value)
+        : value_(new int(value)) {
     }
-    X(const X& other) = delete;
-    X& operator=(const X& other) = delete;
-    X(X&& other) {
-        x_ = exchange(other.x_, 0);
+    Boxed(Boxed&& other) noexcept
+        : value_(exchange(other.value_, nullptr)) {
     }
-    X& operator=(X&& other) {
-        x_ = exchange(other.x_, 0);
+    Boxed& operator=(Boxed&& other) noexcept {
+        delete exchange(value_, exchange(other.value_, nullptr));
         return *this;
     }
-    size_t GetX() const {
-        return x_;
+    ~Boxed() {
+        delete value_;
+    }
+    int GetValue() const {
+        return *value_;
     }
 
 private:
-    size_t x_;
+    int* value_;
+};
+
+template <>
+struct IsTriviallyRelocatable<Boxed> : std::true_type {
+};
+
+// Копируемый тип с бросающим перемещением: при переносе должен копироваться
+struct ThrowingMove {
+    explicit ThrowingMove(int v)
+        : value(v) {
+    }
+    ThrowingMove(const ThrowingMove& other)
+        : value(other.value) {
+        if (throw_on_copy) {
+            throw runtime_error("copy failed"s);
+        }
+        ++copies;
+    }
+    ThrowingMove(ThrowingMove&& other) noexcept(false)
+        : value(other.value) {
+        ++moves;
+    }
+    ThrowingMove& operator=(const ThrowingMove&) = default;
+    ThrowingMove& operator=(ThrowingMove&&) = default;
+
+    int value;
+    inline static int copies = 0;
+    inline static int moves = 0;
+    inline static bool throw_on_copy = false;
+};
+
+// Строка, перемещение которой бросает исключение после moves_before_throw
+// удачных перемещений (при отрицательном значении — никогда). Считает живые
+// объекты, чтобы проверять, что исключение не разрушает объект дважды
+struct FragileMove {
+    explicit FragileMove(string v)
+        : value(std::move(v)) {
+        ++alive;
+    }
+    FragileMove(const FragileMove& other)
+        : value(other.value) {
+        ++alive;
+    }
+    FragileMove(FragileMove&& other) noexcept(false) {
+        CountMove();
+        value = std::move(other.value);
+        ++alive;
+    }
+    FragileMove& operator=(const FragileMove&) = default;
+    FragileMove& operator=(FragileMove&& other) noexcept(false) {
+        CountMove();
+        value = std::move(other.value);
+        return *this;
+    }
+    ~FragileMove() {
+        --alive;
+    }
+
+    static void CountMove() {
+        if (moves_before_throw >= 0 && moves_before_throw-- == 0) {
+            throw runtime_error("move failed"s);
+        }
+    }
+
+    string value;
+    inline static int alive = 0;
+    inline static int moves_before_throw = -1;
+};
+
+// Аллокатор с состоянием: считает выделения в общем счётчике и различается по id
+template <typename Type>
+struct CountingAllocator {
+    using value_type = Type;
+    using propagate_on_container_move_assignment = std::false_type;
+
+    CountingAllocator(int allocator_id, int* allocations_counter)
+        : id(allocator_id)
+        , allocations(allocations_counter) {
+    }
+    template <typename Other>
+    CountingAllocator(const CountingAllocator<Other>& other)
+        : id(other.id)
+        , allocations(other.allocations) {
+    }
+
+    Type* allocate(size_t n) {
+        ++*allocations;
+        return std::allocator<Type>().allocate(n);
+    }
+    void deallocate(Type* p, size_t n) {
+        std::allocator<Type>().deallocate(p, n);
+    }
+
+    int id;
+    int* allocations;
+};
+
+template <typename Lhs, typename Rhs>
+bool operator==(const CountingAllocator<Lhs>& lhs, const CountingAllocator<Rhs>& rhs) {
+    return lhs.id == rhs.id;
+}
+
+template <typename Lhs, typename Rhs>
+bool operator!=(const CountingAllocator<Lhs>& lhs, const CountingAllocator<Rhs>& rhs) {
+    return !(lhs == rhs);
+}
+
+// ReallocAllocator, считающий вызовы reallocate
+template <typename Type>
+struct CountingReallocAllocator : ReallocAllocator<Type> {
+    using value_type = Type;
+
+    template <typename Other>
+    struct rebind {
+        using other = CountingReallocAllocator<Other>;
+    };
+
+    CountingReallocAllocator() noexcept = default;
+    template <typename Other>
+    CountingReallocAllocator(const CountingReallocAllocator<Other>& /*other*/) noexcept {
+    }
+
+    Type* reallocate(Type* ptr, size_t old_count, size_t new_count) noexcept {
+        ++reallocations;
+        return ReallocAllocator<Type>::reallocate(ptr, old_count, new_count);
+    }
+
+    inline static int reallocations = 0;
 };
 
 SimpleVector<int> GenerateVector(size_t size) {
@@ -41,8 +238,11 @@ SimpleVector<int> GenerateVector(size_t size) {
 void TestTemporaryObjConstructor() {
     const size_t size = 1000000;
     cout << "Test with temporary object, copy elision"s << endl;
+    const AllocationScope scope;
     SimpleVector<int> moved_vector(GenerateVector(size));
     assert(moved_vector.GetSize() == size);
+    // Память выделяется один раз, в GenerateVector
+    assert(scope.GetAllocations() == 1 && scope.GetBytes() == size * sizeof(int));
     cout << "Done!"s << endl << endl;
 }
 
@@ -51,8 +251,10 @@ void TestTemporaryObjOperator() {
     cout << "Test with temporary object, operator="s << endl;
     SimpleVector<int> moved_vector;
     assert(moved_vector.GetSize() == 0);
+    const AllocationScope scope;
     moved_vector = GenerateVector(size);
     assert(moved_vector.GetSize() == size);
+    assert(scope.GetAllocations() == 1);
     cout << "Done!"s << endl << endl;
 }
 
@@ -62,9 +264,11 @@ void TestNamedMoveConstructor() {
     SimpleVector<int> vector_to_move(GenerateVector(size));
     assert(vector_to_move.GetSize() == size);
 
+    const AllocationScope scope;
     SimpleVector<int> moved_vector(move(vector_to_move));
     assert(moved_vector.GetSize() == size);
     assert(vector_to_move.GetSize() == 0);
+    assert(scope.GetAllocations() == 0);
     cout << "Done!"s << endl << endl;
 }
 
@@ -74,9 +278,12 @@ void TestNamedMoveOperator() {
     SimpleVector<int> vector_to_move(GenerateVector(size));
     assert(vector_to_move.GetSize() == size);
 
-    SimpleVector<int> moved_vector = move(vector_to_move);
+    SimpleVector<int> moved_vector(size / 2);
+    const AllocationScope scope;
+    moved_vector = move(vector_to_move);
     assert(moved_vector.GetSize() == size);
     assert(vector_to_move.GetSize() == 0);
+    assert(scope.GetAllocations() == 0);
     cout << "Done!"s << endl << endl;
 }
 
@@ -88,8 +295,9 @@ void TestNoncopiableMoveConstructor() {
         vector_to_move.PushBack(X(i));
     }
 
+    const AllocationScope scope;
     SimpleVector<X> moved_vector = move(vector_to_move);
-    assert(moved_vector.GetSize() == size);
+    assert(moved_vector.GetSize() == size && scope.GetAllocations() == 0);
     assert(vector_to_move.GetSize() == 0);
 
     for (size_t i = 0; i < size; ++i) {
@@ -161,12 +369,1816 @@ void TestNoncopiableResize() {
     assert(v.GetSize() == 5);
     v.Resize(4);
     assert(v.GetSize() == 4);
+    const AllocationScope scope;
     v.Resize(10);
     assert(v.GetSize() == 10);
-    cout << "Done!"s << endl;
+    // Рост до нового размера выделяет память один раз
+    assert(scope.GetAllocations() == 1 && scope.GetBytes() == v.GetCapacity() * sizeof(X));
+    cout << "Done!"s << endl << endl;
     
 }
 
+void TestUninitializedCapacity() {
+    cout << "Test uninitialized capacity"s << endl;
+    {
+        SimpleVector<Counted> v;
+        v.Reserve(100);
+        assert(v.GetCapacity() == 100);
+        assert(Counted::alive == 0);
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(Counted(i));
+        }
+        assert(Counted::alive == 10);
+        v.PopBack();
+        assert(Counted::alive == 9);
+        v.Erase(v.begin());
+        assert(Counted::alive == 8);
+        assert(v[0].GetValue() == 1);
+        v.Insert(v.begin() + 2, Counted(42));
+        assert(Counted::alive == 9);
+        assert(v[2].GetValue() == 42);
+        while (v.GetSize() > 3) {
+            v.PopBack();
+        }
+        assert(Counted::alive == 3);
+        SimpleVector<Counted> copy(v);
+        assert(Counted::alive == 6);
+        v.Clear();
+        assert(Counted::alive == 3);
+        assert(v.GetCapacity() == 100);
+    }
+    assert(Counted::alive == 0);
+    cout << "Done!"s << endl << endl;
+}
+
+void TestEmplace() {
+    cout << "Test emplace"s << endl;
+    SimpleVector<pair<string, int>> v;
+    auto& first = v.EmplaceBack("b"s, 2);
+    assert(first.first == "b"s && first.second == 2);
+    v.Emplace(v.begin(), "a"s, 1);
+    v.Emplace(v.end(), "c"s, 3);
+    assert(v.GetSize() == 3);
+    assert(v[0].first == "a"s && v[1].first == "b"s && v[2].first == "c"s);
+
+    // Аргумент может ссылаться на элемент самого вектора, в том числе при перевыделении
+    SimpleVector<string> strings;
+    strings.PushBack("hello"s);
+    assert(strings.GetSize() == strings.GetCapacity());
+    strings.PushBack(strings[0]);
+    strings.Insert(strings.begin(), strings[1]);
+    assert(strings.GetSize() == 3);
+    for (const auto& str : strings) {
+        assert(str == "hello"s);
+    }
+
+    SimpleVector<X> xs;
+    xs.EmplaceBack(1u);
+    auto it = xs.Emplace(xs.begin(), 2u);
+    assert(it == xs.begin() && it->GetX() == 2);
+    assert(xs[1].GetX() == 1);
+    cout << "Done!"s << endl << endl;
+}
+
+void TestRelocation() {
+    cout << "Test relocation strategies"s << endl;
+    SimpleVector<Boxed> boxes;
+    for (int i = 0; i < 20; ++i) {
+        boxes.EmplaceBack(i);
+    }
+    boxes.Insert(boxes.begin() + 5, Boxed(100));
+    boxes.Erase(boxes.begin());
+    boxes.Erase(boxes.end() - 1);
+    assert(boxes.GetSize() == 19);
+    assert(boxes[4].GetValue() == 100);
+    assert(boxes[0].GetValue() == 1 && boxes[18].GetValue() == 18);
+
+    SimpleVector<ThrowingMove> values;
+    values.Reserve(2);
+    values.EmplaceBack(1);
+    values.EmplaceBack(2);
+    ThrowingMove::copies = ThrowingMove::moves = 0;
+    values.Reserve(10);
+    assert(ThrowingMove::copies == 2 && ThrowingMove::moves == 0);
+
+    SimpleVector<string> strings;
+    for (int i = 0; i < 10; ++i) {
+        strings.PushBack(to_string(i));
+    }
+    strings.Insert(strings.begin(), "a"s);
+    strings.Insert(strings.begin() + 6, "b"s);
+    strings.Insert(strings.end() - 1, "c"s);
+    strings.Erase(strings.begin() + 1);
+    const SimpleVector<string> expected = {"a"s, "1"s, "2"s, "3"s, "4"s, "b"s, "5"s, "6"s, "7"s, "8"s, "c"s, "9"s};
+    assert(strings == expected);
+
+    {
+        // Если сдвиг хвоста при удалении бросает исключение, все элементы остаются
+        // созданными и размер не меняется: ни один объект не разрушается дважды
+        SimpleVector<FragileMove> fragile;
+        fragile.Reserve(5);
+        for (int i = 0; i < 5; ++i) {
+            fragile.EmplaceBack("value longer than the small string buffer "s + to_string(i));
+        }
+        for (const size_t count : {size_t{1}, size_t{2}}) {
+            FragileMove::moves_before_throw = 1;
+            try {
+                fragile.Erase(fragile.cbegin() + 1, fragile.cbegin() + 1 + count);
+                assert(false);
+            } catch (const runtime_error&) {
+            }
+            FragileMove::moves_before_throw = -1;
+            assert(fragile.GetSize() == 5 && FragileMove::alive == 5);
+        }
+        FragileMove::moves_before_throw = 1;
+        try {
+            fragile.Erase(fragile.cbegin());
+            assert(false);
+        } catch (const runtime_error&) {
+        }
+        FragileMove::moves_before_throw = -1;
+        assert(fragile.GetSize() == 5 && FragileMove::alive == 5);
+        fragile.Erase(fragile.cbegin() + 3);
+        assert(fragile.GetSize() == 4 && FragileMove::alive == 4);
+    }
+    assert(FragileMove::alive == 0);
+    cout << "Done!"s << endl << endl;
+}
+
+void TestAllocators() {
+    cout << "Test allocators"s << endl;
+    {
+        std::pmr::monotonic_buffer_resource arena;
+        std::pmr::polymorphic_allocator<std::pmr::string> alloc(&arena);
+        SimpleVector<std::pmr::string, std::pmr::polymorphic_allocator<std::pmr::string>> v(alloc);
+        v.EmplaceBack("a string long enough to skip the small string buffer"s);
+        v.PushBack(std::pmr::string("b"));
+        assert(v[0].get_allocator().resource() == &arena);
+        assert(v[1].get_allocator().resource() == &arena);
+
+        auto copy = v;
+        assert(copy.GetAllocator().resource() == std::pmr::get_default_resource());
+        auto moved = std::move(v);
+        assert(moved.GetAllocator().resource() == &arena);
+        assert(moved.GetSize() == 2 && v.IsEmpty());
+    }
+    {
+        int allocations = 0;
+        CountingAllocator<int> first(1, &allocations);
+        CountingAllocator<int> second(2, &allocations);
+        SimpleVector<int, CountingAllocator<int>> a(3, 7, first);
+        SimpleVector<int, CountingAllocator<int>> b(first);
+        assert(allocations == 1);
+        const int* data = a.Data();
+        b = std::move(a);
+        assert(allocations == 1 && b.Data() == data);
+
+        // Аллокатор не передаётся при перемещении и не равен — элементы перемещаются поштучно
+        SimpleVector<int, CountingAllocator<int>> c(second);
+        c = std::move(b);
+        assert(allocations == 2);
+        assert(c.GetAllocator().id == 2 && c.GetSize() == 3 && c[2] == 7);
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+void TestSmallSimpleVector() {
+    cout << "Test small simple vector"s << endl;
+    SmallSimpleVector<string, 4> v = {"a"s, "b"s};
+    assert(!v.IsOnHeap() && v.GetCapacity() == 4);
+    v.PushBack("c"s);
+    v.Insert(v.begin(), "z"s);
+    assert(!v.IsOnHeap() && v.GetSize() == 4);
+    v.EmplaceBack(3, 'x');
+    assert(v.IsOnHeap() && v.GetCapacity() == 8);
+    const SmallSimpleVector<string, 4> expected = {"z"s, "a"s, "b"s, "c"s, "xxx"s};
+    assert(v == expected);
+    v.Erase(v.begin() + 1);
+    assert(v[1] == "b"s && v.GetSize() == 4);
+
+    // Перемещение из встроенного буфера и из кучи
+    SmallSimpleVector<string, 4> inline_vector = {"1"s, "2"s};
+    SmallSimpleVector<string, 4> moved_inline = std::move(inline_vector);
+    assert(inline_vector.IsEmpty() && moved_inline.GetSize() == 2 && moved_inline[1] == "2"s);
+    const string* heap_data = v.begin();
+    SmallSimpleVector<string, 4> moved_heap = std::move(v);
+    assert(v.IsEmpty() && !v.IsOnHeap() && moved_heap.begin() == heap_data);
+
+    moved_inline.swap(moved_heap);
+    assert(moved_inline.IsOnHeap() && moved_inline.GetSize() == 4);
+    assert(!moved_heap.IsOnHeap() && moved_heap[0] == "1"s);
+    moved_heap = moved_inline;
+    const SmallSimpleVector<string, 4> bigger = {"zz"s};
+    assert(moved_heap == moved_inline && moved_heap < bigger);
+
+    SmallSimpleVector<X, 2> xs(5);
+    xs.Resize(1);
+    xs.PushBack(X(7));
+    assert(xs.GetSize() == 2 && xs[1].GetX() == 7);
+
+    {
+        // Исключение при сдвиге хвоста оставляет все элементы созданными
+        SmallSimpleVector<FragileMove, 4> fragile;
+        for (int i = 0; i < 3; ++i) {
+            fragile.EmplaceBack("value longer than the small string buffer"s);
+        }
+        FragileMove::moves_before_throw = 0;
+        try {
+            fragile.Erase(fragile.begin());
+            assert(false);
+        } catch (const runtime_error&) {
+        }
+        FragileMove::moves_before_throw = -1;
+        assert(fragile.GetSize() == 3 && FragileMove::alive == 3);
+    }
+    assert(FragileMove::alive == 0);
+    cout << "Done!"s << endl << endl;
+}
+
+// Сравнивает скорость создания коротких векторов: SimpleVector выделяет память
+// в куче на каждый вектор, SmallSimpleVector обходится встроенным буфером
+void BenchmarkSmallVectorAllocations() {
+    const size_t count = 1000000;
+    const int elements = 6;
+    cout << "Benchmark short-lived vectors of "s << elements << " elements"s << endl;
+
+    auto measure = [&](auto make_vector) {
+        const auto start = chrono::steady_clock::now();
+        size_t checksum = 0;
+        for (size_t i = 0; i < count; ++i) {
+            auto v = make_vector();
+            for (int j = 0; j < elements; ++j) {
+                v.PushBack(j);
+            }
+            checksum += v[elements - 1];
+        }
+        const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        assert(checksum == count * (elements - 1));
+        return count / elapsed.count();
+    };
+
+    const double heap_rate = measure([] {
+        return SimpleVector<int>();
+    });
+    const double inline_rate = measure([] {
+        return SmallSimpleVector<int, 8>();
+    });
+    cout << "SimpleVector<int>:         "s << static_cast<size_t>(heap_rate) << " vectors/sec"s << endl;
+    cout << "SmallSimpleVector<int, 8>: "s << static_cast<size_t>(inline_rate) << " vectors/sec"s << endl;
+    cout << "Done!"s << endl;
+}
+
+void TestGrowthPolicies() {
+    cout << "Test growth policies"s << endl;
+    {
+        SimpleVector<int> v;
+        for (int i = 0; i < 5; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.GetCapacity() == 8);
+        v.Resize(9);
+        assert(v.GetCapacity() == 16);
+    }
+    {
+        SimpleVector<int, std::allocator<int>, GoldenGrowth> v;
+        size_t capacities[6] = {};
+        for (size_t& capacity : capacities) {
+            v.Insert(v.begin(), 0);
+            capacity = v.GetCapacity();
+        }
+        const size_t expected[6] = {1, 2, 3, 4, 6, 6};
+        assert(equal(begin(capacities), end(capacities), begin(expected)));
+    }
+    {
+        // Шаг роста не больше 64 байт, то есть 16 элементов int
+        SimpleVector<int, std::allocator<int>, CappedGrowth<64>> v(100);
+        v.PushBack(1);
+        assert(v.GetCapacity() == 116);
+        v.Resize(200);
+        assert(v.GetCapacity() == 200);
+    }
+    {
+        SimpleVector<char, std::allocator<char>, AllocationRoundingGrowth<>> v;
+        v.PushBack('a');
+        assert(v.GetCapacity() == 16);
+        v.Resize(5000);
+        assert(v.GetCapacity() == 8192);
+    }
+    {
+        SmallSimpleVector<int, 2, GoldenGrowth> v = {1, 2};
+        v.PushBack(3);
+        assert(v.GetCapacity() == 3);
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+void TestRangeOperations() {
+    cout << "Test range operations"s << endl;
+    const int values[] = {1, 2, 3, 4, 5};
+    SimpleVector<int> v(begin(values), end(values));
+    assert(v.GetSize() == 5 && v.GetCapacity() == 5);
+
+    // Вставка в середину без перевыделения и с ним
+    v.Reserve(8);
+    const list<int> extra = {10, 11};
+    auto it = v.Insert(v.begin() + 1, extra.begin(), extra.end());
+    assert(it == v.begin() + 1 && v.GetCapacity() == 8);
+    assert((v == SimpleVector<int>{1, 10, 11, 2, 3, 4, 5}));
+    it = v.Insert(v.begin() + 3, 3, 0);
+    assert(*it == 0 && v.GetCapacity() == 16);
+    assert((v == SimpleVector<int>{1, 10, 11, 0, 0, 0, 2, 3, 4, 5}));
+
+    it = v.Erase(v.begin() + 1, v.begin() + 6);
+    assert(*it == 2);
+    assert((v == SimpleVector<int>{1, 2, 3, 4, 5}));
+    it = v.Erase(v.begin(), v.begin());
+    assert(it == v.begin() && v.GetSize() == 5);
+
+    v.Append(begin(values), begin(values) + 2);
+    assert((v == SimpleVector<int>{1, 2, 3, 4, 5, 1, 2}));
+
+    // Однопроходные итераторы
+    istringstream input("7 8 9"s);
+    v.Insert(v.begin(), istream_iterator<int>(input), istream_iterator<int>());
+    assert((v == SimpleVector<int>{7, 8, 9, 1, 2, 3, 4, 5, 1, 2}));
+
+    // Assign переиспользует память, если её хватает, и выделяет ровно столько, сколько нужно, если нет
+    const size_t capacity = v.GetCapacity();
+    v.Assign(extra.begin(), extra.end());
+    assert((v == SimpleVector<int>{10, 11}) && v.GetCapacity() == capacity);
+    SimpleVector<int> big(100);
+    v.Assign(big.begin(), big.end());
+    assert(v.GetSize() == 100 && v.GetCapacity() == 100);
+
+    // Вставка копий элемента самого вектора
+    SimpleVector<string> strings = {"a"s, "b"s};
+    strings.Insert(strings.begin(), 3, strings[1]);
+    strings.Reserve(10);
+    strings.Insert(strings.begin(), 2, strings[4]);
+    assert((strings == SimpleVector<string>{"b"s, "b"s, "b"s, "b"s, "b"s, "a"s, "b"s}));
+
+    // Перемещение диапазона некопируемых элементов
+    SimpleVector<X> source;
+    source.EmplaceBack(1u);
+    source.EmplaceBack(2u);
+    SimpleVector<X> target;
+    target.EmplaceBack(0u);
+    target.Insert(target.end(), make_move_iterator(source.begin()), make_move_iterator(source.end()));
+    assert(target.GetSize() == 3 && target[2].GetX() == 2 && source[1].GetX() == 0);
+    target.Erase(target.begin(), target.end());
+    assert(target.IsEmpty());
+    cout << "Done!"s << endl << endl;
+}
+
+void TestShrink() {
+    cout << "Test shrink and memory usage"s << endl;
+    {
+        SimpleVector<int> v(100);
+        v.Resize(10);
+        assert(v.GetCapacity() == 100);
+        auto usage = v.MemoryUsage();
+        assert(usage.reserved_bytes == 100 * sizeof(int) && usage.used_bytes == 10 * sizeof(int));
+        v.ShrinkTo(50);
+        assert(v.GetCapacity() == 50);
+        v.ShrinkTo(5);
+        assert(v.GetCapacity() == 10);
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.GetCapacity() == 0 && v.Data() == nullptr);
+    }
+    {
+        SimpleVector<string, std::allocator<string>, HysteresisGrowth<>> v(64, "value"s);
+        v.Erase(v.begin() + 17, v.end());
+        assert(v.GetCapacity() == 64);
+        v.PopBack();
+        assert(v.GetSize() == 16 && v.GetCapacity() == 64);
+        v.Erase(v.begin());
+        assert(v.GetSize() == 15 && v.GetCapacity() == 30);
+        assert(v[14] == "value"s);
+        v.Clear();
+        assert(v.GetCapacity() == 0);
+    }
+    {
+        SmallSimpleVector<string, 2> v = {"a"s, "b"s, "c"s};
+        assert(v.IsOnHeap());
+        v.PopBack();
+        v.ShrinkToFit();
+        assert(!v.IsOnHeap() && v.GetCapacity() == 2 && v[1] == "b"s);
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+void TestCopyPath() {
+    cout << "Test copy path"s << endl;
+    SimpleVector<ThrowingMove> source;
+    for (int i = 0; i < 10; ++i) {
+        source.EmplaceBack(i);
+    }
+    ThrowingMove::copies = ThrowingMove::moves = 0;
+    AllocationScope scope;
+    SimpleVector<ThrowingMove> copy(source);
+    assert(ThrowingMove::copies == 10 && ThrowingMove::moves == 0);
+    // Копия выделяет память один раз ровно под элементы
+    assert(scope.GetAllocations() == 1 && scope.GetBytes() == 10 * sizeof(ThrowingMove));
+    assert(copy.GetCapacity() == 10 && copy[9].value == 9);
+
+    // Копия из std::initializer_list тоже создаётся без лишних присваиваний
+    ThrowingMove::copies = 0;
+    scope = AllocationScope();
+    SimpleVector<ThrowingMove> listed = {ThrowingMove(1), ThrowingMove(2)};
+    assert(ThrowingMove::copies == 2 && listed.GetCapacity() == 2 && scope.GetAllocations() == 1);
+
+    // Присваивание переиспользует память, если её хватает
+    SimpleVector<int> ints(100);
+    const int* data = ints.Data();
+    const SimpleVector<int> small = {1, 2, 3};
+    scope = AllocationScope();
+    ints = small;
+    assert(ints.Data() == data && ints == small && ints.GetCapacity() == 100 && scope.GetAllocations() == 0);
+    SimpleVector<int> tiny;
+    tiny = ints;
+    assert(tiny == small && tiny.GetCapacity() == 3 && scope.GetAllocations() == 1);
+    cout << "Done!"s << endl << endl;
+}
+
+// Сравнивает результаты операторов с std::equal и std::lexicographical_compare
+// для различий в каждой позиции, в том числе на границах векторных блоков
+template <typename Type>
+void CheckComparisonAgainstStd(const vector<Type>& base, Type changed) {
+    for (size_t pos = 0; pos < base.size(); ++pos) {
+        vector<Type> other = base;
+        other[pos] = changed;
+        for (size_t cut : {base.size(), pos + 1, pos}) {
+            const SimpleVector<Type> lhs(base.begin(), base.end());
+            const SimpleVector<Type> rhs(other.begin(), other.begin() + cut);
+            const bool equal = std::equal(base.begin(), base.end(), other.begin(), other.begin() + cut);
+            const bool less = std::lexicographical_compare(base.begin(), base.end(), other.begin(), other.begin() + cut);
+            const bool greater = std::lexicographical_compare(other.begin(), other.begin() + cut, base.begin(), base.end());
+            assert((lhs == rhs) == equal);
+            assert((lhs < rhs) == less);
+            assert((rhs < lhs) == greater);
+        }
+    }
+}
+
+void TestComparison() {
+    cout << "Test comparison"s << endl;
+    {
+        vector<uint8_t> bytes(70);
+        iota(bytes.begin(), bytes.end(), uint8_t{100});
+        CheckComparisonAgainstStd(bytes, uint8_t{0});
+        CheckComparisonAgainstStd(bytes, uint8_t{255});
+    }
+    {
+        vector<int32_t> ints(40);
+        iota(ints.begin(), ints.end(), -20);
+        CheckComparisonAgainstStd(ints, int32_t{-1000});
+        CheckComparisonAgainstStd(ints, int32_t{1000});
+    }
+    {
+        vector<float> floats(20, 1.5f);
+        CheckComparisonAgainstStd(floats, -1.0f);
+        CheckComparisonAgainstStd(floats, 3.0f);
+    }
+    {
+        // Разные байты, но равные значения, и одинаковые байты, но неравные значения
+        const SimpleVector<double> zeros = {0.0, 1.0};
+        const SimpleVector<double> negative_zeros = {-0.0, 1.0};
+        assert(zeros == negative_zeros && !(zeros < negative_zeros) && !(negative_zeros < zeros));
+        const SimpleVector<double> nans = {1.0, std::numeric_limits<double>::quiet_NaN()};
+        assert(!(nans < nans));
+        const SimpleVector<double> nans_copy(nans);
+        assert(nans != nans_copy && !(nans < nans_copy));
+    }
+    {
+        const SmallSimpleVector<char, 4> small = {'a', 'b'};
+        const SmallSimpleVector<char, 4> longer = {'a', 'b', 'c'};
+        assert(small != longer && small < longer && !(longer < small));
+        const SimpleVector<string> words = {"a"s, "b"s};
+        assert(words < SimpleVector<string>({"a"s, "c"s}));
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+void TestParallelAlgorithms() {
+    cout << "Test parallel algorithms"s << endl;
+    ThreadPool pool(3);
+    const size_t size = 1'000'003;
+    {
+        SimpleVector<int> v;
+        ParallelFill(pool, v, size, 7);
+        assert(v.GetSize() == size && v.GetCapacity() == size);
+        assert(all_of(v.begin(), v.end(), [](int x) { return x == 7; }));
+        ParallelFill(kParallelPolicy, v, 1);
+        assert(ParallelReduce(pool, v, int64_t{10}) == static_cast<int64_t>(size) + 10);
+
+        ParallelTransform(pool, v, [](int x) { return x * 3; });
+        SimpleVector<int64_t> indices;
+        iota(v.begin(), v.end(), 0);
+        ParallelTransform(kSequencedPolicy, v, indices, [](int x) { return int64_t{x} * 2; });
+        assert(indices.GetSize() == size && indices[size - 1] == 2 * int64_t{size - 1});
+        const int64_t expected = static_cast<int64_t>(size) * (size - 1);
+        assert(ParallelReduce(pool, indices, int64_t{0}) == expected);
+        // Операция ассоциативна, но не коммутативна: части сворачиваются по порядку
+        SimpleVector<string> digits(50'000, "x"s);
+        digits[0] = "a"s;
+        digits[49'999] = "z"s;
+        const string joined = ParallelReduce(pool, digits, ""s);
+        assert(joined.size() == 50'000 && joined.front() == 'a' && joined.back() == 'z');
+    }
+    {
+        // Значение — элемент самого вектора, который Clear разрушает до заполнения
+        SimpleVector<string> v{"first string longer than the small buffer"s, "second string longer than the small buffer"s};
+        ParallelFill(pool, v, 100'000, v[1]);
+        assert(v.GetSize() == 100'000);
+        assert(all_of(v.begin(), v.end(), [](const string& s) { return s == "second string longer than the small buffer"s; }));
+    }
+    {
+        // Границы частей, кроме крайних, приходятся на начало страниц
+        SimpleVector<int> v(size);
+        const ChunkPartition partition(v.Data(), size, sizeof(int), pool.GetThreadCount());
+        assert(partition.GetChunkCount() == pool.GetThreadCount());
+        for (size_t chunk = 1; chunk < partition.GetChunkCount(); ++chunk) {
+            assert(reinterpret_cast<uintptr_t>(v.Data() + partition.GetBegin(chunk)) % kParallelPageSize == 0);
+        }
+        // Маленькие массивы не делятся
+        assert(ChunkPartition(v.Data(), 100, sizeof(int), 4).GetChunkCount() == 1);
+    }
+    {
+        SimpleVector<int> v(size);
+        uint32_t state = 12345;
+        for (int& item : v) {
+            state = state * 1103515245 + 12345;
+            item = static_cast<int>(state >> 8);
+        }
+        vector<int> expected(v.begin(), v.end());
+        sort(expected.begin(), expected.end());
+        ParallelSort(pool, v);
+        assert(equal(v.begin(), v.end(), expected.begin(), expected.end()));
+        ParallelSort(pool, v, greater<>());
+        assert(is_sorted(v.begin(), v.end(), greater<>()));
+    }
+    {
+        // Если создание элемента бросает исключение, созданные в других потоках
+        // элементы разрушаются, а вектор остаётся прежним
+        SimpleVector<int> source(size);
+        SimpleVector<Counted> out;
+        try {
+            ParallelTransform(pool, source, out, [counter = make_shared<atomic<size_t>>(0)](int x) {
+                if (++*counter == 900'000) {
+                    throw runtime_error("transform failed"s);
+                }
+                return Counted(x);
+            });
+            assert(false);
+        } catch (const runtime_error&) {
+        }
+        assert(out.IsEmpty() && Counted::alive == 0);
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+void TestConcurrentSimpleVector() {
+    cout << "Test concurrent simple vector"s << endl;
+    {
+        ConcurrentSimpleVector<string> v;
+        assert(v.IsEmpty());
+        const string& first = v.EmplaceBack(30, 'a');
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(to_string(i));
+        }
+        // Рост не переносит элементы
+        assert(&first == &v[0] && first == string(30, 'a'));
+        assert(v.GetSize() == 1001 && v.At(1000) == "999"s);
+        try {
+            v.At(1001);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+        v.Clear();
+        assert(v.IsEmpty());
+    }
+    {
+        const int thread_count = 4;
+        const int per_thread = 50'000;
+        ConcurrentSimpleVector<int> v;
+        atomic<bool> done = false;
+        // Читатель проверяет, что все элементы до GetSize уже созданы
+        thread reader([&] {
+            while (!done) {
+                const size_t size = v.GetSize();
+                if (size != 0) {
+                    assert(v[size - 1] >= 0 && v[0] >= 0);
+                }
+            }
+        });
+        vector<thread> writers;
+        for (int t = 0; t < thread_count; ++t) {
+            writers.emplace_back([&v, t] {
+                for (int i = 0; i < per_thread; ++i) {
+                    v.PushBack(t * per_thread + i);
+                }
+            });
+        }
+        for (thread& writer : writers) {
+            writer.join();
+        }
+        done = true;
+        reader.join();
+
+        assert(v.GetSize() == static_cast<size_t>(thread_count * per_thread));
+        vector<bool> seen(thread_count * per_thread);
+        for (size_t i = 0; i < v.GetSize(); ++i) {
+            assert(!seen[v[i]]);
+            seen[v[i]] = true;
+        }
+    }
+    {
+        ConcurrentSimpleVector<Counted> v;
+        v.Reserve(100);
+        for (int i = 0; i < 20; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(Counted::alive == 20);
+    }
+    assert(Counted::alive == 0);
+    cout << "Done!"s << endl << endl;
+}
+
+void TestSegmentedVector() {
+    cout << "Test segmented vector"s << endl;
+    using Segmented = SegmentedVector<int, 4>;
+    {
+        Segmented v;
+        assert(v.IsEmpty() && v.GetCapacity() == 0);
+        v.PushBack(0);
+        const int* first = &v[0];
+        for (int i = 1; i < 10; ++i) {
+            v.PushBack(i);
+        }
+        // Рост добавляет блоки и не переносит элементы
+        assert(&v[0] == first);
+        assert(v.GetSize() == 10 && v.GetChunkCount() == 3 && v.GetCapacity() == 12);
+        assert(v.At(9) == 9);
+        try {
+            v.At(10);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+
+        // Итераторы произвольного доступа работают со стандартными алгоритмами
+        assert(v.end() - v.begin() == 10 && v.begin()[5] == 5);
+        assert(*(v.end() - 1) == 9 && *lower_bound(v.begin(), v.end(), 7) == 7);
+        reverse(v.begin(), v.end());
+        assert(v[0] == 9 && v[9] == 0);
+        sort(v.begin(), v.end());
+        assert(is_sorted(v.cbegin(), v.cend()));
+        Segmented::ConstIterator it = v.begin();
+        assert(it == v.cbegin() && it + 3 > it);
+
+        v.Resize(5);
+        assert(v.GetSize() == 5 && v.GetChunkCount() == 3);
+        v.ShrinkToFit();
+        assert(v.GetChunkCount() == 2);
+        v.PopBack();
+        assert(v.GetSize() == 4 && v[3] == 3);
+        v.Resize(7);
+        assert(v[6] == 0);
+    }
+    {
+        const Segmented v = {1, 2, 3, 4, 5, 6};
+        Segmented copy(v);
+        assert(copy == v && copy.GetSize() == 6);
+        copy.PushBack(7);
+        assert(v < copy && copy != v);
+        Segmented moved(move(copy));
+        assert(copy.IsEmpty() && moved.GetSize() == 7);
+        copy = v;
+        assert(copy == v);
+
+        // Непрерывная копия
+        SimpleVector<int> flat = v.Flatten();
+        assert(flat.GetSize() == 6 && flat.GetCapacity() == 6 && flat[5] == 6);
+    }
+    {
+        SegmentedVector<X, 2> v;
+        for (int i = 0; i < 5; ++i) {
+            v.EmplaceBack(i);
+        }
+        SimpleVector<X> flat = move(v).Flatten();
+        assert(flat.GetSize() == 5 && flat[4].GetX() == 4 && v.IsEmpty());
+    }
+    {
+        SegmentedVector<Counted> v(100, Counted(1));
+        assert(Counted::alive == 100);
+        v.Clear();
+        assert(Counted::alive == 0 && v.GetCapacity() >= 100);
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+void TestMappedSimpleVector() {
+    cout << "Test mapped simple vector"s << endl;
+    struct Record {
+        uint64_t key;
+        double value;
+    };
+    const string path = (filesystem::temp_directory_path() / "simple_vector_mapped_test.bin").string();
+    filesystem::remove(path);
+    {
+        MappedSimpleVector<Record> v(path);
+        assert(v.IsEmpty() && v.GetCapacity() == 0);
+        for (uint64_t i = 0; i < 10'000; ++i) {
+            v.PushBack({i, i * 0.5});
+        }
+        assert(v.GetSize() == 10'000 && v.GetCapacity() >= 10'000);
+        v.Insert(v.begin(), {100'000, 1.0});
+        v.Erase(v.begin() + 1);
+        assert(v[0].key == 100'000 && v[1].key == 1 && v.GetSize() == 10'000);
+        v.ShrinkToFit();
+        assert(v.GetCapacity() == 10'000);
+        v.Flush();
+    }
+    {
+        // Файл открывается без чтения элементов, размер хранится в заголовке
+        MappedSimpleVector<Record> v(path);
+        assert(v.GetSize() == 10'000 && v.At(9'999).key == 9'999 && v[9'999].value == 9'999 * 0.5);
+        v.PopBack();
+        v.Resize(10'002);
+        assert(v[9'999].key == 0 && v[10'001].value == 0.0);
+        MappedSimpleVector<Record> moved(move(v));
+        assert(moved.GetSize() == 10'002 && moved.GetPath() == path);
+    }
+    {
+        MappedSimpleVector<Record> v(path);
+        assert(v.GetSize() == 10'002);
+        v.Clear();
+        assert(v.IsEmpty());
+    }
+    try {
+        // Размер элемента не совпадает с тем, что записан в заголовке
+        MappedSimpleVector<uint32_t> wrong(path);
+        assert(false);
+    } catch (const runtime_error&) {
+    }
+    filesystem::remove(path);
+    cout << "Done!"s << endl << endl;
+}
+
+struct Point {
+    int x;
+    int y;
+};
+
+// Тип с владеющим членом сериализуется через точку настройки
+struct Tagged {
+    string tag;
+    int value;
+};
+
+template <>
+struct Serializer<Tagged> {
+    template <typename Writer>
+    static void Write(Writer& writer, const Tagged& item) {
+        Serializer<string>::Write(writer, item.tag);
+        writer.Write(&item.value, sizeof(item.value));
+    }
+
+    template <typename Reader>
+    static Tagged Read(Reader& reader) {
+        Tagged item{Serializer<string>::Read(reader), 0};
+        reader.Read(&item.value, sizeof(item.value));
+        return item;
+    }
+};
+
+void TestSerialization() {
+    cout << "Test serialization"s << endl;
+    {
+        SimpleVector<Point> points;
+        for (int i = 0; i < 1000; ++i) {
+            points.PushBack({i, -i});
+        }
+        stringstream stream;
+        Serialize(stream, points);
+        assert(stream.str().size() == SerializationHeader::kSize + 1000 * sizeof(Point));
+        const SimpleVector<Point> restored = Deserialize<Point>(stream);
+        assert(restored.GetSize() == 1000 && restored[999].x == 999 && restored[999].y == -999);
+
+        // Представление над буфером не копирует элементы
+        SimpleVector<char> buffer;
+        Serialize(buffer, points);
+        const SimpleVectorView<const Point> view = ViewSerialized<Point>(buffer.Data(), buffer.GetSize());
+        assert(view.GetSize() == 1000 && view.At(10).x == 10);
+        assert(reinterpret_cast<const char*>(view.begin()) == buffer.Data() + SerializationHeader::kSize);
+
+        try {
+            ViewSerialized<int>(buffer.Data(), buffer.GetSize());
+            assert(false);
+        } catch (const SerializationError&) {
+        }
+        try {
+            Deserialize<Point>(buffer.Data(), buffer.GetSize() - 1);
+            assert(false);
+        } catch (const SerializationError&) {
+        }
+        buffer[0] = 'x';
+        try {
+            Deserialize<Point>(buffer.Data(), buffer.GetSize());
+            assert(false);
+        } catch (const SerializationError&) {
+        }
+    }
+    {
+        const SimpleVector<string> words = {"alpha"s, ""s, string(100, 'z')};
+        SimpleVector<char> buffer;
+        Serialize(buffer, words);
+        assert(Deserialize<string>(buffer.Data(), buffer.GetSize()) == words);
+
+        const SimpleVector<Tagged> tagged = {{"a"s, 1}, {"bb"s, 2}};
+        stringstream stream;
+        Serialize(stream, tagged);
+        const SimpleVector<Tagged> restored = Deserialize<Tagged>(stream);
+        assert(restored.GetSize() == 2 && restored[1].tag == "bb"s && restored[1].value == 2);
+    }
+    {
+        // Заголовок с огромным количеством не выделяет память заранее
+        SimpleVector<char> buffer;
+        Serialize(buffer, SimpleVector<uint64_t>(3, 7));
+        buffer[16] = static_cast<char>(0xFF);
+        buffer[23] = static_cast<char>(0x7F);
+        try {
+            Deserialize<uint64_t>(buffer.Data(), buffer.GetSize());
+            assert(false);
+        } catch (const SerializationError&) {
+        }
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+// Функция, принимающая любой непрерывный массив int без копирования
+int SumView(SimpleVectorView<const int> values) {
+    return accumulate(values.begin(), values.end(), 0);
+}
+
+void TestSimpleVectorView() {
+    cout << "Test simple vector view"s << endl;
+    {
+        const SimpleVector<int> v = {1, 2, 3, 4, 5};
+        assert(SumView(v) == 15);
+        SmallSimpleVector<int, 4> small = {10, 20};
+        assert(SumView(small) == 30);
+        int raw[] = {7, 8, 9};
+        assert(SumView(raw) == 24);
+        assert(SumView({}) == 0);
+
+        ArrayPtr<int> items(3);
+        items[0] = 1;
+        items[1] = 2;
+        SimpleVectorView items_view(items, 2);
+        static_assert(is_same_v<decltype(items_view), SimpleVectorView<int>>);
+        assert(SumView(items_view) == 3);
+    }
+    {
+        const SimpleVector<int> v = {1, 2, 3, 4, 5};
+        const SimpleVectorView<const int> view = v;
+        assert(view.Data() == v.Data() && view.GetSize() == 5);
+
+        const auto middle = view.Subview(1, 3);
+        assert(middle.GetSize() == 3 && middle[0] == 2 && middle[2] == 4);
+        assert(view.Subview(3).GetSize() == 2);
+        assert(view.Subview(4, 100).GetSize() == 1);
+        assert(view.Subview(5).IsEmpty());
+        try {
+            view.Subview(6);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+        try {
+            view.At(5);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+        assert(view.First(2) == SimpleVectorView<const int>(v.Data(), 2));
+        assert(view.Last(2)[0] == 4 && view.Last(0).IsEmpty());
+    }
+    {
+        // Сравнение частей векторов и представлений константных и изменяемых элементов
+        SimpleVector<int> lhs = {1, 2, 3, 1, 2, 3};
+        const SimpleVector<int> rhs = {1, 2, 4};
+        SimpleVectorView<int> whole = lhs;
+        const SimpleVectorView<const int> frozen = rhs;
+        assert(whole.First(3) == whole.Last(3));
+        assert(whole.First(3) != frozen);
+        assert(whole.First(3) < frozen && frozen > whole.Last(3));
+        assert(whole.First(2) <= frozen && frozen >= whole.First(2));
+        assert(whole.First(2) == frozen.First(2));
+        assert(whole.Subview(0, 0) < frozen);
+
+        // Через представление изменяемых элементов элементы меняются у владельца
+        whole.Last(3)[2] = 4;
+        for (int& value : whole.First(3)) {
+            value *= 10;
+        }
+        assert(lhs == SimpleVector<int>({10, 20, 30, 1, 2, 4}));
+        assert(whole.Last(3) == frozen);
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+// Считает события, которые CallSiteStatsInstrumentation передаёт обработчику
+atomic<size_t> hooked_vector_events{0};
+
+void CountVectorEvent(const VectorEvent& /*event*/) noexcept {
+    ++hooked_vector_events;
+}
+
+void TestInstrumentation() {
+    cout << "Test instrumentation"s << endl;
+    using Instrumented = SimpleVector<int, allocator<int>, InstrumentedGrowth<CallSiteStatsInstrumentation>>;
+    static_assert(!HasVectorEventHook<DoublingGrowth>::value);
+    static_assert(HasShrinkCapacity<InstrumentedGrowth<CallSiteStatsInstrumentation, HysteresisGrowth<>>>::value);
+    // Неинструментированный вектор не хранит метку места
+    static_assert(sizeof(Instrumented) == sizeof(SimpleVector<int>) + sizeof(const VectorCallSite*));
+
+    CallSiteStatsInstrumentation::Reset();
+    CallSiteStatsInstrumentation::SetHook(CountVectorEvent);
+    const VectorCallSite* hot_site = SIMPLE_VECTOR_CALL_SITE();
+    const VectorCallSite* reserved_site = SIMPLE_VECTOR_CALL_SITE();
+    assert(hot_site != reserved_site && hot_site->line + 1 == reserved_site->line);
+    {
+        Instrumented hot;
+        hot.SetCallSite(hot_site);
+        for (int i = 0; i < 100; ++i) {
+            hot.PushBack(i);
+        }
+        hot.Insert(hot.begin(), -1);
+        hot.Erase(hot.begin());
+        // Пустой диапазон ничего не сдвигает и не порождает события
+        hot.Erase(hot.begin() + 5, hot.begin() + 5);
+
+        Instrumented reserved;
+        reserved.SetCallSite(reserved_site);
+        reserved.Reserve(100);
+        for (int i = 0; i < 100; ++i) {
+            reserved.PushBack(i);
+        }
+
+        // Метка относится к объекту и не передаётся копии
+        const Instrumented copy(hot);
+        assert(copy.GetCallSite() == nullptr && hot.GetCallSite() == hot_site);
+    }
+    CallSiteStatsInstrumentation::SetHook(nullptr);
+
+    // Первым идёт место, где вектор чаще всего переносил элементы
+    const auto stats = CallSiteStatsInstrumentation::GetStats();
+    assert(stats.size() == 3);
+    const VectorCallSiteStats& hot = stats[0];
+    assert(hot.site == hot_site);
+    // Вместимость 1, 2, 4, ..., 128: первый буфер и 7 переносов 1 + 2 + ... + 64 элементов
+    assert(hot.allocations == 8 && hot.reallocations == 7);
+    assert(hot.bytes_moved == 127 * sizeof(int) && hot.peak_capacity == 128);
+    assert(hot.elements_shifted == 200);
+    for (const VectorCallSiteStats& site_stats : stats) {
+        if (site_stats.site == reserved_site) {
+            assert(site_stats.allocations == 1 && site_stats.reallocations == 0 && site_stats.peak_capacity == 100);
+        } else if (site_stats.site == nullptr) {
+            assert(site_stats.allocations == 1 && site_stats.peak_capacity == 100);
+        }
+    }
+    assert(hooked_vector_events == 8 + 2 + 1 + 1);
+
+    CallSiteStatsInstrumentation::Reset();
+    assert(CallSiteStatsInstrumentation::GetStats().empty());
+    cout << "Done!"s << endl << endl;
+}
+
+#ifdef SIMPLE_VECTOR_HARDENED
+// Выполняет action в дочернем процессе и сообщает, завершился ли тот через abort
+template <typename Action>
+bool DiesWithAbort(Action action) {
+    cout.flush();
+    const pid_t pid = fork();
+    if (pid == 0) {
+        freopen("/dev/null", "w", stderr);
+        action();
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+}
+#endif
+
+void TestHardening() {
+    cout << "Test hardening"s << endl;
+#ifdef SIMPLE_VECTOR_HARDENED
+    {
+        SimpleVector<int> v = {1, 2, 3};
+        const SimpleVector<int>::ConstIterator second = v.begin() + 1;
+        assert(*second == 2 && second - v.cbegin() == 1 && second != v.end());
+        assert(count(v.begin(), v.end(), 2) == 1);
+
+        // Вставка без перевыделения сохраняет итераторы, если ничего не сдвигается
+        v.Reserve(10);
+        const auto first = v.begin();
+        v.PushBack(4);
+        assert(*first == 1);
+
+        assert(DiesWithAbort([&v] { static_cast<void>(v[4]); }));
+        assert(DiesWithAbort([&v] { static_cast<void>(*v.end()); }));
+        assert(DiesWithAbort([&v] { static_cast<void>(v.end() + 1); }));
+        assert(DiesWithAbort([&v, first] { v.Reserve(100); static_cast<void>(*first); }));
+        assert(DiesWithAbort([&v, first] { v.Insert(v.begin(), 0); static_cast<void>(*first); }));
+        assert(DiesWithAbort([&v, first] { v.Erase(v.end() - 1); static_cast<void>(first + 1); }));
+        assert(DiesWithAbort([&v, first] { v.Clear(); static_cast<void>(first == v.begin()); }));
+        assert(DiesWithAbort([&v] { SimpleVector<int> other = {1}; v.Erase(other.begin()); }));
+        assert(DiesWithAbort([] { SimpleVector<int>().PopBack(); }));
+        assert(DiesWithAbort([&v] { SimpleVectorView<int>(v).Last(5); }));
+    }
+    {
+        // SmallSimpleVector проверяет индексы и позиции так же, как SimpleVector
+        SmallSimpleVector<int, 4> v = {1, 2, 3};
+        SmallSimpleVector<int, 4> other = {1};
+        assert(DiesWithAbort([&v] { static_cast<void>(v[3]); }));
+        assert(DiesWithAbort([&v] { v.Insert(v.end() + 1, 0); }));
+        assert(DiesWithAbort([&v, &other] { v.Erase(other.begin()); }));
+        assert(DiesWithAbort([&v] { v.SwapRemove(v.end()); }));
+        assert(DiesWithAbort([] { SmallSimpleVector<int, 4>().PopBack(); }));
+        assert(DiesWithAbort([&v] {
+            const size_t indices[] = {2, 1};
+            v.EraseIndices(SimpleVectorView<const size_t>(indices, 2));
+        }));
+    }
+    {
+        const string path = (filesystem::temp_directory_path() / "simple_vector_hardened_test.bin").string();
+        filesystem::remove(path);
+        {
+            MappedSimpleVector<int> v(path);
+            v.PushBack(1);
+            assert(DiesWithAbort([&v] { v.Insert(v.end() + 1, 0); }));
+            assert(DiesWithAbort([&v] { v.Erase(v.end()); }));
+            v.PopBack();
+            assert(DiesWithAbort([&v] { v.PopBack(); }));
+        }
+        filesystem::remove(path);
+    }
+    {
+        // Доступ по индексу проверяется и в SegmentedVector и ConcurrentSimpleVector
+        SegmentedVector<int> segmented = {1, 2};
+        const SegmentedVector<int>& const_segmented = segmented;
+        assert(DiesWithAbort([&segmented] { static_cast<void>(segmented[2]); }));
+        assert(DiesWithAbort([&const_segmented] { static_cast<void>(const_segmented[2]); }));
+        assert(DiesWithAbort([] { SegmentedVector<int>().PopBack(); }));
+
+        ConcurrentSimpleVector<int> concurrent;
+        concurrent.PushBack(1);
+        const ConcurrentSimpleVector<int>& const_concurrent = concurrent;
+        assert(DiesWithAbort([&concurrent] { static_cast<void>(concurrent[1]); }));
+        assert(DiesWithAbort([&const_concurrent] { static_cast<void>(const_concurrent[1]); }));
+    }
+#else
+    static_assert(is_same_v<SimpleVector<int>::Iterator, int*>);
+    static_assert(is_same_v<SimpleVector<int>::ConstIterator, const int*>);
+#endif
+    cout << "Done!"s << endl << endl;
+}
+
+#if SIMPLE_VECTOR_HAS_CONSTEXPR
+// Таблица квадратов, построенная во время компиляции
+constexpr SimpleVector<int> MakeSquares(int count) {
+    SimpleVector<int> squares;
+    for (int i = 0; i < count; ++i) {
+        squares.PushBack(i * i);
+    }
+    return squares;
+}
+
+constexpr auto kSquares = ToArray<8>(MakeSquares(8));
+static_assert(kSquares[0] == 0 && kSquares[7] == 49);
+
+static_assert([] {
+    SimpleVector<int> v = {3, 1, 2};
+    SimpleVector<int> copy(v);
+    copy.Reserve(10);
+    copy.Insert(copy.begin(), 0);
+    copy.Erase(copy.begin() + 1);
+    copy.Resize(4);
+    return v.GetSize() == 3 && copy.GetCapacity() == 10 && copy[0] == 0 && copy[3] == 0 && !(v < copy) &&
+           copy < v && v == SimpleVector<int>{3, 1, 2};
+}());
+
+static_assert([] {
+    // Типы с нетривиальным переносом переносятся поэлементно и во время компиляции
+    SimpleVector<SimpleVector<int>> nested;
+    for (int i = 0; i < 5; ++i) {
+        nested.EmplaceBack(static_cast<size_t>(i), i);
+    }
+    nested.PopBack();
+    return nested.GetSize() == 4 && nested[3].GetSize() == 3 && nested[3][2] == 3;
+}());
+#endif
+
+void TestConstexpr() {
+    cout << "Test constexpr"s << endl;
+    {
+        SimpleVector<int> v = {1, 2, 3};
+        const array<int, 3> table = ToArray<3>(v);
+        assert(table[0] == 1 && table[2] == 3);
+        try {
+            ToArray<4>(v);
+            assert(false);
+        } catch (const length_error&) {
+        }
+    }
+    static_assert(DoublingGrowth::NextCapacity(4, 5, sizeof(int)) == 8);
+#if SIMPLE_VECTOR_HAS_CONSTEXPR
+    assert(kSquares[3] == 9);
+#endif
+    cout << "Done!"s << endl << endl;
+}
+
+void TestAlignedAllocator() {
+    cout << "Test aligned allocator"s << endl;
+    static_assert(SimpleVector<float>::GetAlignment() == alignof(float));
+    static_assert(SimpleVector<float, AlignedAllocator<float>>::GetAlignment() == kCacheLineSize);
+    {
+        SimpleVector<float, AlignedAllocator<float>> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(reinterpret_cast<uintptr_t>(v.Data()) % kCacheLineSize == 0);
+        }
+        assert(!v.IsHugePageBacked());
+        SimpleVector<float, AlignedAllocator<float>> copy(v);
+        assert(copy == v && reinterpret_cast<uintptr_t>(copy.Data()) % kCacheLineSize == 0);
+
+        SimpleVector<char, AlignedAllocator<char, 4096, kNoHugePages>> page_aligned(10);
+        assert(reinterpret_cast<uintptr_t>(page_aligned.Data()) % 4096 == 0);
+        assert(page_aligned.GetAlignment() == 4096);
+        assert(!SimpleVector<float>(100).IsHugePageBacked());
+    }
+    {
+        // Большой блок выравнивается по большой странице. Примет ли система запрос
+        // на большие страницы, зависит от ядра, поэтому здесь проверяется только,
+        // что память работает как обычно
+        using Huge = SimpleVector<float, AlignedAllocator<float>>;
+        Huge v(kHugePageSize / sizeof(float) + 1, 1.0f);
+#if defined(__linux__)
+        assert(reinterpret_cast<uintptr_t>(v.Data()) % kHugePageSize == 0);
+#endif
+        v.PushBack(2.0f);
+        assert(v[0] == 1.0f && v[v.GetSize() - 1] == 2.0f);
+        v.Clear();
+        v.ShrinkToFit();
+        assert(!v.IsHugePageBacked());
+
+        // Без пула hugetlbfs блок выделяется на обычных страницах
+        SimpleVector<double, AlignedAllocator<double, kCacheLineSize, kHugePageSize, true>> explicit_pages(
+            kHugePageSize / sizeof(double), 3.0);
+        assert(explicit_pages[explicit_pages.GetSize() - 1] == 3.0);
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+void TestReallocGrowth() {
+    cout << "Test realloc growth"s << endl;
+    static_assert(HasReallocate<ReallocAllocator<int>>::value);
+    static_assert(HasReallocate<AlignedAllocator<int>>::value);
+    static_assert(!HasReallocate<std::allocator<int>>::value);
+    {
+        // Тривиально переносимые элементы растут через reallocate
+        CountingReallocAllocator<int>::reallocations = 0;
+        SimpleVector<int, CountingReallocAllocator<int>> v;
+        for (int i = 0; i < 100000; ++i) {
+            v.PushBack(i);
+        }
+        assert(CountingReallocAllocator<int>::reallocations > 0);
+        for (int i = 0; i < 100000; ++i) {
+            assert(v[i] == i);
+        }
+        // Элемент, ссылающийся на сам вектор, копируется до перевыделения
+        v.ShrinkToFit();
+        v.PushBack(v[0]);
+        v.EmplaceBack(v[v.GetSize() - 2]);
+        assert(v[100000] == 0 && v[100001] == 99999);
+
+        const int before = CountingReallocAllocator<int>::reallocations;
+        v.Reserve(v.GetCapacity() * 4);
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(CountingReallocAllocator<int>::reallocations == before + 2);
+        assert(v.GetCapacity() == 10 && v[9] == 9);
+
+        SimpleVector<int, CountingReallocAllocator<int>> copy(v);
+        assert(copy == v);
+    }
+    {
+        // Остальные типы переносятся поэлементно
+        CountingReallocAllocator<string>::reallocations = 0;
+        SimpleVector<string, CountingReallocAllocator<string>> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(to_string(i));
+        }
+        v.ShrinkToFit();
+        assert(CountingReallocAllocator<string>::reallocations == 0);
+        assert(v.GetSize() == 100 && v[99] == "99"s);
+    }
+    {
+        // Большой блок AlignedAllocator меняет размер на месте, если за ним есть
+        // место, иначе переносится в новый блок; выравнивание сохраняется всегда
+        using Huge = SimpleVector<float, AlignedAllocator<float>>;
+        Huge v(kHugePageSize / sizeof(float), 1.0f);
+        v.Reserve(v.GetCapacity() * 2);
+        v.Resize(v.GetCapacity());
+        v[v.GetSize() - 1] = 2.0f;
+        v.Reserve(v.GetCapacity() + 1);
+#if defined(__linux__)
+        assert(reinterpret_cast<uintptr_t>(v.Data()) % kHugePageSize == 0);
+#endif
+        assert(v[0] == 1.0f && v[v.GetSize() - 1] == 2.0f);
+        v.Resize(kHugePageSize / sizeof(float));
+        v.ShrinkToFit();
+        assert(v[v.GetSize() - 1] == 1.0f);
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+void TestSoAVector() {
+    cout << "Test SoAVector"s << endl;
+    using Trades = SoAVector<int, double, string>;
+    static_assert(Trades::kColumnCount == 3);
+    static_assert(Trades::kRowSize == sizeof(int) + sizeof(double) + sizeof(string));
+    {
+        Trades v;
+        assert(v.IsEmpty() && v.GetCapacity() == 0);
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack({i, i * 0.5, to_string(i)});
+        }
+        assert(v.GetSize() == 100 && v.GetCapacity() >= 100);
+        const auto [id, price, name] = v[42];
+        assert(id == 42 && price == 21.0 && name == "42"s);
+
+        // Ссылки на поля изменяют запись, по отдельности и целиком
+        get<1>(v[0]) = 7.5;
+        v[1] = Trades::Row{-1, -1.0, "minus"s};
+        assert(get<1>(v[0]) == 7.5 && get<2>(v[1]) == "minus"s);
+
+        // Столбцы непрерывны и обходятся по отдельности
+        const Trades& cv = v;
+        const double* prices = cv.ColumnData<1>();
+        assert(prices + 99 == &get<1>(cv[99]));
+        int id_sum = 0;
+        for (const int item : cv.Column<0>()) {
+            id_sum += item;
+        }
+        assert(id_sum == 99 * 100 / 2 - 1 - 1);
+
+        // Поля добавляемой записи могут ссылаться на сам вектор
+        v.ShrinkToFit();
+        assert(v.GetCapacity() == 100);
+        v.EmplaceBack(get<0>(v[99]), get<1>(v[99]), get<2>(v[99]));
+        assert(v.GetSize() == 101 && get<2>(v[100]) == "99"s);
+        assert(get<0>(v.At(100)) == 99);
+        try {
+            v.At(101);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+
+        v.Erase(0);
+        v.Erase(10, 20);
+        assert(v.GetSize() == 90 && get<0>(v[0]) == -1 && get<2>(v[10]) == "21"s);
+        v.PopBack();
+        v.Resize(95);
+        assert(get<0>(v[94]) == 0 && get<1>(v[94]) == 0.0 && get<2>(v[94]).empty());
+        v.Resize(3);
+        assert(v.GetSize() == 3 && get<2>(v[2]) == "3"s);
+
+        Trades copy(v);
+        assert(copy.GetSize() == 3 && copy[2] == v[2]);
+        Trades moved(move(copy));
+        assert(copy.IsEmpty() && moved.GetSize() == 3);
+        copy = moved;
+        swap(copy, v);
+        assert(copy.GetSize() == 3 && v.GetSize() == 3);
+        v.Clear();
+        assert(v.IsEmpty() && v.GetCapacity() > 0);
+        v.Reserve(1000);
+        assert(v.GetCapacity() == 1000);
+    }
+    {
+        // Одна политика роста управляет всеми столбцами и может освобождать память
+        BasicSoAVector<HysteresisGrowth<>, int, char> v(100);
+        assert(v.GetCapacity() == 100);
+        v.Erase(0, 90);
+        assert(v.GetCapacity() == 20);
+        assert(v.MemoryUsage().used_bytes == 10 * (sizeof(int) + sizeof(char)));
+    }
+    {
+        // Поля с бросающим перемещением при переносе копируются
+        SoAVector<string, ThrowingMove> v;
+        v.EmplaceBack("a"s, ThrowingMove(1));
+        v.Reserve(1);
+        assert(v.GetCapacity() == 1);
+        ThrowingMove::copies = 0;
+        ThrowingMove::moves = 0;
+        v.EmplaceBack("b"s, ThrowingMove(2));
+        assert(ThrowingMove::copies == 1 && ThrowingMove::moves == 1);
+        assert(v.GetSize() == 2 && get<1>(v[0]).value == 1 && get<1>(v[1]).value == 2);
+    }
+    {
+        // Копируемые столбцы переносятся первыми: если копирование бросает
+        // исключение, перемещаемые столбцы ещё не тронуты и записи сохраняются
+        const string name = "name longer than the small string buffer"s;
+        SoAVector<string, ThrowingMove> v;
+        v.EmplaceBack(name, ThrowingMove(1));
+        v.Reserve(1);
+        ThrowingMove::throw_on_copy = true;
+        try {
+            v.EmplaceBack("b"s, ThrowingMove(2));
+            assert(false);
+        } catch (const runtime_error&) {
+        }
+        ThrowingMove::throw_on_copy = false;
+        assert(v.GetSize() == 1 && v.GetCapacity() == 1);
+        assert(get<0>(v[0]) == name && get<1>(v[0]).value == 1);
+    }
+    {
+        // Если сдвиг при удалении бросает исключение, поля остаются созданными
+        SoAVector<FragileMove, int> v;
+        for (int i = 0; i < 5; ++i) {
+            v.EmplaceBack(FragileMove("field longer than the small string buffer"s), i);
+        }
+        FragileMove::moves_before_throw = 0;
+        try {
+            v.Erase(1);
+            assert(false);
+        } catch (const runtime_error&) {
+        }
+        FragileMove::moves_before_throw = -1;
+        assert(v.GetSize() == 5 && FragileMove::alive == 5);
+        v.Erase(0, 2);
+        assert(v.GetSize() == 3 && FragileMove::alive == 3 && get<1>(v[0]) == 2);
+    }
+    assert(FragileMove::alive == 0);
+    cout << "Done!"s << endl << endl;
+}
+
+void TestBatchErase() {
+    cout << "Test SwapRemove, EraseIf and EraseIndices"s << endl;
+    {
+        SimpleVector<int> v{0, 1, 2, 3, 4};
+        auto it = v.SwapRemove(v.begin() + 1);
+        assert(*it == 4 && v == SimpleVector<int>({0, 4, 2, 3}));
+        it = v.SwapRemove(v.end() - 1);
+        assert(it == v.end() && v == SimpleVector<int>({0, 4, 2}));
+    }
+    {
+        // Удалённые элементы разрушаются, а не остаются за концом вектора
+        Counted::alive = 0;
+        SimpleVector<Counted> v;
+        for (int i = 0; i < 10; ++i) {
+            v.EmplaceBack(i);
+        }
+        v.SwapRemove(v.begin());
+        assert(Counted::alive == 9 && v[0].GetValue() == 9);
+
+        int calls = 0;
+        const size_t removed = v.EraseIf([&calls](const Counted& item) {
+            ++calls;
+            return item.GetValue() % 2 == 0;
+        });
+        assert(removed == 4 && calls == 9 && Counted::alive == 5);
+        assert(v[0].GetValue() == 9 && v[1].GetValue() == 1 && v[4].GetValue() == 7);
+        assert(v.EraseIf([](const Counted&) { return false; }) == 0);
+
+        const SimpleVector<size_t> indices{0, 2, 4};
+        v.EraseIndices(indices);
+        assert(v.GetSize() == 2 && Counted::alive == 2);
+        assert(v[0].GetValue() == 1 && v[1].GetValue() == 5);
+        v.EraseIndices({});
+        assert(v.GetSize() == 2);
+    }
+    assert(Counted::alive == 0);
+    {
+        // Тривиальные элементы и удаление подряд идущих индексов
+        SimpleVector<int> v(10);
+        iota(v.begin(), v.end(), 0);
+        const size_t indices[] = {0, 1, 5, 8, 9};
+        v.EraseIndices(indices);
+        assert(v == SimpleVector<int>({2, 3, 4, 6, 7}));
+
+        SimpleVector<int, std::allocator<int>, HysteresisGrowth<>> shrinking(100);
+        shrinking.EraseIf([](int) { return true; });
+        assert(shrinking.IsEmpty() && shrinking.GetCapacity() == 0);
+    }
+    {
+        SmallSimpleVector<string, 4> v{"a"s, "b"s, "c"s, "d"s, "e"s};
+        v.SwapRemove(v.begin());
+        assert(v[0] == "e"s && v.GetSize() == 4);
+        assert(v.EraseIf([](const string& item) { return item == "b"s; }) == 1);
+        const size_t indices[] = {0, 2};
+        v.EraseIndices(indices);
+        assert(v.GetSize() == 1 && v[0] == "c"s);
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+void TestBufferPool() {
+    cout << "Test buffer pool"s << endl;
+    static_assert(BufferPool::GetClassIndex(1) == 0 && BufferPool::GetClassIndex(16) == 0);
+    static_assert(BufferPool::GetClassIndex(17) == 1 && BufferPool::GetClassBytes(1) == 32);
+    static_assert(BufferPool::GetClassIndex(size_t{1} << 20) == kPoolClassCount - 1);
+    static_assert(BufferPool::GetClassIndex((size_t{1} << 20) + 1) == kPoolClassCount);
+    using Pooled = SimpleVector<int, PooledAllocator<int>, AllocationRoundingGrowth<>>;
+    BufferPool::TrimCurrentThread();
+    {
+        // Блок уничтоженного вектора достаётся следующему вектору того же класса
+        const BufferPoolStats before = BufferPool::GetThreadStats();
+        for (int i = 0; i < 100; ++i) {
+            Pooled v(100);
+            v[99] = i;
+        }
+        const BufferPoolStats after = BufferPool::GetThreadStats();
+        assert(after.misses == before.misses + 1 && after.hits == before.hits + 99);
+        assert(after.cached_blocks == 1 && after.cached_bytes == 512);
+
+        // При росте освобождённые блоки меньших классов тоже попадают в пул
+        Pooled v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(i);
+        }
+        assert(BufferPool::GetThreadStats().cached_blocks > 1);
+        Pooled copy(v);
+        assert(copy == v);
+    }
+    {
+        // Лимит класса ограничивает число хранимых блоков
+        const size_t index = BufferPool::GetClassIndex(64 * sizeof(int));
+        BufferPool::TrimCurrentThread();
+        BufferPool::SetClassLimit(index, 0);
+        {
+            Pooled v(64);
+        }
+        assert(BufferPool::GetThreadStats().cached_blocks == 0);
+        BufferPool::SetClassLimit(index, kDefaultPoolClassLimit);
+        {
+            Pooled v(64);
+        }
+        assert(BufferPool::GetThreadStats().cached_blocks == 1);
+
+        // Блоки больше самого крупного класса не кэшируются
+        {
+            SimpleVector<char, PooledAllocator<char>> huge(BufferPool::GetClassBytes(kPoolClassCount - 1) + 1);
+        }
+        assert(BufferPool::GetThreadStats().cached_blocks == 1);
+    }
+    {
+        // TrimAllThreads очищает списки каждого потока при его следующем обращении к пулу
+        assert(BufferPool::GetThreadStats().cached_blocks > 0);
+        thread([] {
+            {
+                Pooled v(10);
+            }
+            assert(BufferPool::GetThreadStats().cached_blocks == 1);
+            BufferPool::TrimAllThreads();
+        }).join();
+        {
+            Pooled v(10);
+        }
+        assert(BufferPool::GetThreadStats().cached_blocks == 1);
+        BufferPool::TrimCurrentThread();
+        assert(BufferPool::GetThreadStats().cached_blocks == 0);
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+void TestSharedSimpleVector() {
+    cout << "Test SharedSimpleVector"s << endl;
+    {
+        // Копия разделяет буфер, пока кто-нибудь из них не изменится
+        SharedSimpleVector<string> config{"a"s, "b"s, "c"s};
+        const SharedSimpleVector<string> reader = config;
+        assert(reader.Data() == config.Data() && config.IsShared() && reader == config);
+        const SharedSimpleVector<string>& const_config = config;
+        assert(const_config[1] == "b"s && const_config.At(2) == "c"s);
+        assert(const_config.Data() == reader.Data());
+
+        config.PushBack("d"s);
+        assert(!config.IsShared() && !reader.IsShared());
+        assert(config.GetSize() == 4 && reader.GetSize() == 3 && reader[2] == "c"s);
+
+        // Неконстантный доступ отделяет буфер только у разделённого вектора
+        SharedSimpleVector<string> writer = reader;
+        const string* shared_data = writer.Data();
+        writer[0] = "z"s;
+        assert(writer.Data() != shared_data && reader[0] == "a"s && writer[0] == "z"s);
+        const string* own_data = writer.Data();
+        writer[1] = "y"s;
+        assert(writer.Data() == own_data);
+    }
+    {
+        // Снимок не меняется при изменении вектора и держит прежний буфер
+        SharedSimpleVector<int> v(5, 1);
+        SimpleVectorSnapshot<int> snapshot = v.Snapshot();
+        assert(snapshot.Data() == as_const(v).Data() && v.IsShared());
+        v.Mutate().PushBack(2);
+        v.Insert(v.cbegin(), 0);
+        v.Erase(v.cbegin() + 1);
+        assert(v == SharedSimpleVector<int>({0, 1, 1, 1, 1, 2}));
+        assert(snapshot.GetSize() == 5 && accumulate(snapshot.begin(), snapshot.end(), 0) == 5);
+        const SimpleVectorView<const int> view = snapshot.GetView();
+        assert(view.GetSize() == 5 && view[4] == 1);
+        try {
+            snapshot.At(5);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+
+        // Элемент разделённого буфера добавляется до того, как буфер отпущен
+        SharedSimpleVector<int> copy = v;
+        copy.PushBack(as_const(copy)[5]);
+        assert(copy.GetSize() == 7 && copy[6] == 2 && v.GetSize() == 6);
+
+        SharedSimpleVector<int> empty;
+        assert(empty.IsEmpty() && empty.Snapshot().IsEmpty() && empty.begin() == empty.end());
+        empty.Resize(3);
+        assert(empty.GetSize() == 3 && empty.GetCapacity() >= 3);
+        copy = empty;
+        copy.Clear();
+        assert(copy.IsEmpty() && empty.GetSize() == 3);
+        swap(copy, empty);
+        assert(copy.GetSize() == 3 && empty.IsEmpty());
+    }
+    {
+        // Снимки читаются в других потоках, пока владелец меняет вектор
+        SharedSimpleVector<int> published(SimpleVector<int>(1000, 7));
+        vector<thread> readers;
+        atomic<int> sums = 0;
+        for (int i = 0; i < 4; ++i) {
+            readers.emplace_back([snapshot = published.Snapshot(), &sums] {
+                sums += accumulate(snapshot.begin(), snapshot.end(), 0);
+            });
+        }
+        for (int i = 0; i < 1000; ++i) {
+            published[i] = 0;
+        }
+        for (thread& reader : readers) {
+            reader.join();
+        }
+        assert(sums == 4 * 7000 && accumulate(as_const(published).begin(), as_const(published).end(), 0) == 0);
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+void TestPackedSimpleVector() {
+    cout << "Test PackedSimpleVector"s << endl;
+    {
+        // Отсортированные идентификаторы с небольшим шагом упаковываются в несколько бит
+        SimpleVector<uint64_t> ids;
+        for (uint64_t i = 0; i < 10000; ++i) {
+            ids.PushBack((uint64_t{1} << 40) + i * 3 + i % 2);
+        }
+        PackedSimpleVector<uint64_t> packed(ids);
+        assert(packed.GetSize() == ids.GetSize() && !packed.IsEmpty());
+        assert(packed.GetBlockBitWidth(0) == 9);
+        assert(packed.MemoryUsage().used_bytes * 5 < ids.MemoryUsage().used_bytes);
+        for (size_t i = 0; i < ids.GetSize(); ++i) {
+            assert(packed[i] == ids[i]);
+        }
+        assert(equal(packed.begin(), packed.end(), ids.begin()));
+
+        SimpleVector<uint64_t> decoded(5);
+        packed.DecodeTo(decoded);
+        assert(decoded == ids);
+        try {
+            packed.At(ids.GetSize());
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+    }
+    {
+        // Одинаковые значения занимают 0 бит, а полный разброс — все 64
+        PackedSimpleVector<uint64_t> v;
+        for (size_t i = 0; i < PackedSimpleVector<uint64_t>::kBlockSize; ++i) {
+            v.PushBack(42);
+        }
+        for (size_t i = 0; i < PackedSimpleVector<uint64_t>::kBlockSize; ++i) {
+            v.PushBack(i % 2 == 0 ? 0 : numeric_limits<uint64_t>::max() - i);
+        }
+        v.PushBack(7);
+        assert(v.GetBlockBitWidth(0) == 0 && v.GetBlockBitWidth(1) == 64);
+        assert(v[0] == 42 && v[128] == 0 && v[129] == numeric_limits<uint64_t>::max() - 1 && v[256] == 7);
+        SimpleVector<uint64_t> decoded;
+        v.DecodeTo(decoded);
+        assert(decoded.GetSize() == 257 && decoded[255] == numeric_limits<uint64_t>::max() - 127);
+        assert(decoded[256] == 7);
+    }
+    {
+        // Блок нулевой ширины последний: за ним нет слов, кроме нулевого дополнения
+        PackedSimpleVector<uint32_t> v;
+        for (size_t i = 0; i < PackedSimpleVector<uint32_t>::kBlockSize; ++i) {
+            v.PushBack(7);
+        }
+        assert(v.GetBlockBitWidth(0) == 0);
+        assert(v[5] == 7 && v[PackedSimpleVector<uint32_t>::kBlockSize - 1] == 7);
+        SimpleVector<uint32_t> decoded;
+        v.DecodeTo(decoded);
+        assert(decoded == SimpleVector<uint32_t>(PackedSimpleVector<uint32_t>::kBlockSize, 7));
+    }
+    {
+        // Значения произвольной ширины, в том числе через границы слов, и добавление
+        // к неполному хвосту
+        PackedSimpleVector<uint32_t> v{1, 2, 3};
+        SimpleVector<uint32_t> expected{1, 2, 3};
+        SimpleVector<uint32_t> more;
+        uint32_t state = 12345;
+        for (int i = 0; i < 1000; ++i) {
+            state = state * 1103515245u + 12345u;
+            more.PushBack(state >> (i % 32));
+            expected.PushBack(state >> (i % 32));
+        }
+        v.Append(more);
+        SimpleVector<uint32_t> decoded;
+        v.DecodeTo(decoded);
+        assert(decoded == expected && v.GetSize() == 1003);
+        assert(v == PackedSimpleVector<uint32_t>(expected));
+        assert((v != PackedSimpleVector<uint32_t>{1, 2}));
+        v.Clear();
+        assert(v.IsEmpty() && v.begin() == v.end());
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+void TestFlatContainers() {
+    cout << "Test FlatSet and FlatMap"s << endl;
+    {
+        // Несортированный вход сортируется один раз, повторы удаляются
+        FlatSet<int> set{5, 1, 4, 1, 5, 9, 2, 6};
+        const SimpleVector<int> expected{1, 2, 4, 5, 6, 9};
+        assert(set.GetView() == SimpleVectorView<const int>(expected));
+        assert(set.Contains(4) && !set.Contains(3) && set.Find(7) == set.end());
+        assert(*set.LowerBound(3) == 4 && set.LowerBound(10) == set.end());
+        assert(set.Insert(3) && !set.Insert(3) && set.GetSize() == 7);
+        assert(set.Erase(1) && !set.Erase(1) && *set.begin() == 2);
+
+        // Слияние: новые элементы вперемешку с имеющимися, с повторами
+        const vector<int> batch{10, 0, 5, 7, 0, 8};
+        set.InsertRange(batch.begin(), batch.end());
+        const SimpleVector<int> merged{0, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+        assert(set.GetView() == SimpleVectorView<const int>(merged));
+        // Все новые элементы больше имеющихся: они дописываются в конец
+        const int tail[] = {12, 11};
+        set.InsertRange(begin(tail), end(tail));
+        assert(set.GetSize() == 12 && *(set.end() - 1) == 12);
+        assert(set.EraseIf([](int x) { return x % 2 != 0; }) == 5);
+        assert((set == FlatSet<int>{0, 2, 4, 6, 8, 10, 12}));
+
+        FlatSet<int, greater<int>> descending(SimpleVector<int>{1, 3, 2, 3});
+        assert(*descending.begin() == 3 && descending.GetSize() == 3 && descending.Contains(1));
+    }
+    {
+        // Значения с бросающим перемещением при слиянии копируются, поэтому
+        // исключение не оставило бы словарь с перемещёнными значениями
+        FlatMap<int, ThrowingMove> map;
+        map.TryEmplace(1, 10);
+        map.TryEmplace(3, 30);
+        const pair<int, ThrowingMove> batch[] = {{2, ThrowingMove(20)}};
+        ThrowingMove::copies = 0;
+        map.InsertRange(begin(batch), end(batch));
+        assert(map.At(1).value == 10 && map.At(2).value == 20 && map.At(3).value == 30);
+        // Одна копия — при сборке новых пар, две — при слиянии
+        assert(ThrowingMove::copies == 3);
+    }
+    {
+        // Поиск в порядке Эйтцингера находит то же, что и двоичный поиск
+        SimpleVector<int> values;
+        for (int i = 0; i < 1000; ++i) {
+            values.PushBack(i * 3);
+        }
+        const FlatSet<int> set(std::move(values));
+        const EytzingerSet<int> tree(set);
+        assert(tree.GetSize() == set.GetSize());
+        for (int key = -2; key < 3005; ++key) {
+            const int* found = tree.LowerBound(key);
+            const int* expected = set.LowerBound(key);
+            assert(expected == set.end() ? found == nullptr : found != nullptr && *found == *expected);
+            assert(tree.Contains(key) == set.Contains(key));
+        }
+        assert(EytzingerSet<int>().LowerBound(1) == nullptr);
+    }
+    {
+        FlatMap<string, int> map{{"b"s, 2}, {"a"s, 1}, {"b"s, 20}, {"c"s, 3}};
+        const SimpleVector<string> keys{"a"s, "b"s, "c"s};
+        const SimpleVector<int> values{1, 2, 3};
+        assert(map.GetSize() == 3 && map.Keys() == SimpleVectorView<const string>(keys));
+        assert(as_const(map).Values() == SimpleVectorView<const int>(values));
+        assert(map.At("b"s) == 2 && map.Find("z"s) == nullptr && !map.Contains("z"s));
+        try {
+            map.At("z"s);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+        map["d"s] += 4;
+        assert(!map.Insert("a"s, 10) && map.At("a"s) == 1);
+        assert(!map.InsertOrAssign("a"s, 10) && map.At("a"s) == 10);
+        assert(map.TryEmplace("aa"s, 5).second && map.Keys()[1] == "aa"s && map.Values()[1] == 5);
+
+        const vector<pair<string, int>> batch{{"ab"s, 6}, {"c"s, 30}, {"0"s, 0}, {"e"s, 7}};
+        map.InsertRange(batch.begin(), batch.end());
+        const SimpleVector<string> merged_keys{"0"s, "a"s, "aa"s, "ab"s, "b"s, "c"s, "d"s, "e"s};
+        const SimpleVector<int> merged_values{0, 10, 5, 6, 2, 3, 4, 7};
+        assert(map.Keys() == SimpleVectorView<const string>(merged_keys));
+        assert(as_const(map).Values() == SimpleVectorView<const int>(merged_values));
+        assert(map.Erase("aa"s) && !map.Erase("aa"s) && map.GetSize() == 7 && map.At("ab"s) == 6);
+
+        FlatMap<string, int> copy = map;
+        assert(copy == map);
+        copy.Values()[0] = 100;
+        assert(copy != map);
+        map.Clear();
+        assert(map.IsEmpty());
+    }
+    {
+        // Некопируемые значения переносятся при слиянии
+        FlatMap<int, X> map;
+        map.TryEmplace(1, 10);
+        map.TryEmplace(3, 30);
+        pair<int, X> batch[2] = {{2, X(20)}, {4, X(40)}};
+        map.InsertRange(make_move_iterator(begin(batch)), make_move_iterator(end(batch)));
+        assert(map.GetSize() == 4 && map.At(2).GetX() == 20 && map.At(3).GetX() == 30 && map.At(4).GetX() == 40);
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+void TestBackgroundGrowth() {
+    cout << "Test BackgroundGrowthVector"s << endl;
+    {
+        // Касание страниц запаса не меняет ни элементы, ни вместимость
+        SimpleVector<int> v{1, 2, 3};
+        v.Reserve(100000);
+        v.PrefaultCapacity();
+        assert(v.GetSize() == 3 && v.GetCapacity() == 100000 && v[2] == 3);
+        SimpleVector<int> empty;
+        empty.PrefaultCapacity();
+        assert(empty.GetCapacity() == 0);
+    }
+    {
+        // Блок, начинающийся не с границы страницы, задевает и последнюю страницу:
+        // 4200 байт со смещения 4000 лежат в трёх страницах
+        void* const pages = mmap(nullptr, 4 * kPageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        assert(pages != MAP_FAILED);
+        PrefaultPages(static_cast<unsigned char*>(pages) + 4000, 4200);
+        unsigned char resident[4] = {};
+        assert(mincore(pages, 4 * kPageSize, resident) == 0);
+        assert((resident[0] & 1) && (resident[1] & 1) && (resident[2] & 1) && !(resident[3] & 1));
+        munmap(pages, 4 * kPageSize);
+    }
+    {
+        // Элементы переносятся в заранее выделенную память
+        SimpleVector<string> v{"a"s, "b"s};
+        ArrayPtr<string> storage(10);
+        const string* block = storage.Get();
+        v.AdoptStorage(std::move(storage));
+        assert(v.GetCapacity() == 10 && v.Data() == block && v[0] == "a"s && v[1] == "b"s);
+        v.PushBack("c"s);
+        assert(v.GetSize() == 3 && v.GetCapacity() == 10);
+    }
+    {
+        // Следующий буфер готовится после отметки в 75% и подменяет рост
+        BackgroundGrowthVector<string> v(75, 0);
+        for (int i = 0; i < 4; ++i) {
+            v.PushBack(to_string(i));
+        }
+        assert(v.GetCapacity() == 4 && v.HasPendingGrowth());
+        // Новый элемент ссылается на элемент, который переедет в новый буфер
+        v.PushBack(v[0]);
+        assert(!v.HasPendingGrowth() && v.GetCapacity() == 8 && v.GetSize() == 5 && v[4] == "0"s);
+        for (int i = 5; i < 1000; ++i) {
+            v.EmplaceBack(to_string(i));
+        }
+        assert(v.GetSize() == 1000 && v.GetCapacity() == 1024);
+        for (int i = 0; i < 1000; ++i) {
+            assert(v[i] == (i == 4 ? "0"s : to_string(i)));
+        }
+        v.PopBack();
+        assert(v.GetVector().GetSize() == 999 && *(v.end() - 1) == "998"s);
+        v.Clear();
+        assert(v.IsEmpty() && v.begin() == v.end());
+    }
+    {
+        // Маленькие буферы растут на месте, без фонового потока
+        BackgroundGrowthVector<int> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(i);
+        }
+        assert(!v.HasPendingGrowth() && v.GetSize() == 1000 && v[999] == 999);
+        v.Reserve(1 << 20);
+        assert(v.GetCapacity() == 1 << 20 && !v.IsGrowthReady());
+    }
+    cout << "Done!"s << endl << endl;
+}
+
 int main() {
     TestTemporaryObjConstructor();
     TestTemporaryObjOperator();
@@ -177,5 +2189,34 @@ int main() {
     TestNoncopiableInsert();
     TestNoncopiableErase();
     TestNoncopiableResize();
+    TestUninitializedCapacity();
+    TestEmplace();
+    TestRelocation();
+    TestAllocators();
+    TestSmallSimpleVector();
+    TestGrowthPolicies();
+    TestRangeOperations();
+    TestShrink();
+    TestCopyPath();
+    TestComparison();
+    TestParallelAlgorithms();
+    TestConcurrentSimpleVector();
+    TestSegmentedVector();
+    TestMappedSimpleVector();
+    TestSerialization();
+    TestSimpleVectorView();
+    TestInstrumentation();
+    TestHardening();
+    TestConstexpr();
+    TestAlignedAllocator();
+    TestReallocGrowth();
+    TestSoAVector();
+    TestBatchErase();
+    TestBufferPool();
+    TestSharedSimpleVector();
+    TestPackedSimpleVector();
+    TestFlatContainers();
+    TestBackgroundGrowth();
+    BenchmarkSmallVectorAllocations();
     return 0;
 }
@@ -0,0 +1,384 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "growth_policy.h"
+#include "hardening.h"
+#include "simple_vector_view.h"
+
+using namespace std::literals;
+
+// Вектор тривиально копируемых элементов, память которого — отображённый в память
+// файл (mmap с MAP_SHARED). В начале файла лежит заголовок с размером вектора,
+// за ним — элементы, поэтому открытие существующего файла ничего не читает
+// и не копирует: страницы подгружаются при первом обращении.
+// Рост увеличивает файл через ftruncate и расширяет отображение через mremap.
+// Изменения попадают в файл без явной записи; Flush дожидается записи на диск
+template <typename Type, typename GrowthPolicy = DoublingGrowth>
+class MappedSimpleVector {
+    static_assert(std::is_trivially_copyable_v<Type>, "MappedSimpleVector stores only trivially copyable types");
+
+    // Заголовок файла. Его размер кратен выравниванию элементов за ним
+    struct alignas(64) Header {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t element_size;
+        uint64_t size;
+    };
+
+    static_assert(alignof(Type) <= alignof(Header), "element alignment is too large");
+
+    // Признак файла MappedSimpleVector
+    static constexpr uint64_t kMagic = 0x5345'4356'5053'4d53;
+    static constexpr uint32_t kVersion = 1;
+
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+    using GrowthPolicyType = GrowthPolicy;
+
+    // Открывает файл path или создаёт пустой вектор в новом файле.
+    // Выбрасывает std::system_error при ошибке системного вызова и
+    // std::runtime_error, если файл не является вектором элементов такого размера
+    explicit MappedSimpleVector(const std::string& path)
+        : path_(path) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ < 0) {
+            ThrowSystemError("open"s);
+        }
+        try {
+            Open();
+        } catch (...) {
+            Unmap();
+            ::close(fd_);
+            throw;
+        }
+    }
+
+    MappedSimpleVector(const MappedSimpleVector&) = delete;
+    MappedSimpleVector& operator=(const MappedSimpleVector&) = delete;
+
+    // Перемещённый вектор можно только разрушить или присвоить ему другой
+    MappedSimpleVector(MappedSimpleVector&& other) noexcept
+        : path_(std::move(other.path_))
+        , fd_(std::exchange(other.fd_, -1))
+        , header_(std::exchange(other.header_, nullptr))
+        , mapped_bytes_(std::exchange(other.mapped_bytes_, 0)) {
+    }
+
+    MappedSimpleVector& operator=(MappedSimpleVector&& rhs) noexcept {
+        if (this != &rhs) {
+            MappedSimpleVector tmp(std::move(rhs));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    // Снимает отображение и закрывает файл. Данные остаются в файле,
+    // но на диск их записывает ОС, когда сочтёт нужным
+    ~MappedSimpleVector() {
+        Unmap();
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    void swap(MappedSimpleVector& other) noexcept {
+        std::swap(path_, other.path_);
+        std::swap(fd_, other.fd_);
+        std::swap(header_, other.header_);
+        std::swap(mapped_bytes_, other.mapped_bytes_);
+    }
+
+    const std::string& GetPath() const noexcept {
+        return path_;
+    }
+
+    size_t GetSize() const noexcept {
+        return static_cast<size_t>(header_->size);
+    }
+
+    // Возвращает количество элементов, под которые в файле есть место
+    size_t GetCapacity() const noexcept {
+        return (mapped_bytes_ - sizeof(Header)) / sizeof(Type);
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    Type& operator[](size_t index) noexcept {
+        SIMPLE_VECTOR_CHECK(index < GetSize(), "index out of range");
+        return Data()[index];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        SIMPLE_VECTOR_CHECK(index < GetSize(), "index out of range");
+        return Data()[index];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index) {
+        if (index >= GetSize()) {
+            throw std::out_of_range("index out of range"s);
+        }
+        return Data()[index];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= GetSize()) {
+            throw std::out_of_range("index out of range"s);
+        }
+        return Data()[index];
+    }
+
+    // Обнуляет размер, не изменяя вместимость
+    void Clear() noexcept {
+        header_->size = 0;
+    }
+
+    // Изменяет размер. Новые элементы обнуляются, как при value-инициализации
+    void Resize(size_t new_size) {
+        const size_t size = GetSize();
+        if (new_size > size) {
+            if (new_size > GetCapacity()) {
+                Remap(NextCapacity(new_size));
+            }
+            std::memset(static_cast<void*>(Data() + size), 0, (new_size - size) * sizeof(Type));
+        }
+        header_->size = new_size;
+    }
+
+    // Увеличивает файл так, чтобы в нём было место под new_capacity элементов
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > GetCapacity()) {
+            Remap(new_capacity);
+        }
+    }
+
+    // Уменьшает файл до размера вектора
+    void ShrinkToFit() {
+        if (GetSize() < GetCapacity()) {
+            Remap(GetSize());
+        }
+    }
+
+    // Создаёт элемент в конце из args и возвращает ссылку на него
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        // Элемент создаётся до роста, потому что args могут ссылаться на элементы вектора
+        Type item(std::forward<Args>(args)...);
+        const size_t size = GetSize();
+        if (size == GetCapacity()) {
+            Remap(NextCapacity(size + 1));
+        }
+        Type* slot = Data() + size;
+        std::memcpy(static_cast<void*>(slot), &item, sizeof(Type));
+        header_->size = size + 1;
+        return *slot;
+    }
+
+    void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    void PopBack() noexcept {
+        SIMPLE_VECTOR_CHECK(!IsEmpty(), "PopBack on empty vector");
+        --header_->size;
+    }
+
+    // Вставляет значение value в позицию pos и возвращает итератор на него
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        const size_t index = pos - cbegin();
+        const size_t size = GetSize();
+        SIMPLE_VECTOR_CHECK(index <= size, "insert position out of range");
+        const Type item = value;
+        if (size == GetCapacity()) {
+            Remap(NextCapacity(size + 1));
+        }
+        Type* slot = Data() + index;
+        std::memmove(static_cast<void*>(slot + 1), slot, (size - index) * sizeof(Type));
+        std::memcpy(static_cast<void*>(slot), &item, sizeof(Type));
+        header_->size = size + 1;
+        return slot;
+    }
+
+    // Удаляет элемент в позиции pos и возвращает итератор на следующий
+    Iterator Erase(ConstIterator pos) noexcept {
+        const size_t index = pos - cbegin();
+        const size_t size = GetSize();
+        SIMPLE_VECTOR_CHECK(index < size, "erase position out of range");
+        Type* slot = Data() + index;
+        std::memmove(static_cast<void*>(slot), slot + 1, (size - index - 1) * sizeof(Type));
+        header_->size = size - 1;
+        return slot;
+    }
+
+    // Синхронно записывает изменения на диск
+    void Flush() {
+        if (::msync(header_, mapped_bytes_, MS_SYNC) != 0) {
+            ThrowSystemError("msync"s);
+        }
+    }
+
+    // Возвращает указатель на первый элемент в отображённой памяти
+    Type* Data() noexcept {
+        return reinterpret_cast<Type*>(header_ + 1);
+    }
+
+    const Type* Data() const noexcept {
+        return reinterpret_cast<const Type*>(header_ + 1);
+    }
+
+    Iterator begin() noexcept {
+        return Data();
+    }
+
+    Iterator end() noexcept {
+        return Data() + GetSize();
+    }
+
+    ConstIterator begin() const noexcept {
+        return Data();
+    }
+
+    ConstIterator end() const noexcept {
+        return Data() + GetSize();
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    std::string path_;
+    int fd_ = -1;
+    Header* header_ = nullptr;
+    size_t mapped_bytes_ = 0;
+
+    [[noreturn]] static void ThrowSystemError(const std::string& call) {
+        throw std::system_error(errno, std::generic_category(), call);
+    }
+
+    // Отображает файл в память, записывая заголовок в новый файл
+    void Open() {
+        struct stat status {};
+        if (::fstat(fd_, &status) != 0) {
+            ThrowSystemError("fstat"s);
+        }
+        const size_t file_bytes = static_cast<size_t>(status.st_size);
+        const bool created = file_bytes == 0;
+        if (created) {
+            if (::ftruncate(fd_, sizeof(Header)) != 0) {
+                ThrowSystemError("ftruncate"s);
+            }
+        } else if (file_bytes < sizeof(Header) || (file_bytes - sizeof(Header)) % sizeof(Type) != 0) {
+            throw std::runtime_error("file "s + path_ + " is not a MappedSimpleVector"s);
+        }
+
+        mapped_bytes_ = created ? sizeof(Header) : file_bytes;
+        void* address = ::mmap(nullptr, mapped_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (address == MAP_FAILED) {
+            mapped_bytes_ = 0;
+            ThrowSystemError("mmap"s);
+        }
+        header_ = static_cast<Header*>(address);
+
+        if (created) {
+            *header_ = Header{kMagic, kVersion, sizeof(Type), 0};
+        } else if (header_->magic != kMagic || header_->version != kVersion ||
+                   header_->element_size != sizeof(Type) || header_->size > GetCapacity()) {
+            throw std::runtime_error("file "s + path_ + " is not a MappedSimpleVector of this type"s);
+        }
+    }
+
+    void Unmap() noexcept {
+        if (header_ != nullptr) {
+            ::munmap(header_, mapped_bytes_);
+            header_ = nullptr;
+        }
+    }
+
+    size_t NextCapacity(size_t required) const {
+        const size_t max_size = (std::numeric_limits<off_t>::max() - sizeof(Header)) / sizeof(Type);
+        if (required > max_size) {
+            throw std::length_error("MappedSimpleVector is too long"s);
+        }
+        return std::min(GrowthPolicy::NextCapacity(GetCapacity(), required, sizeof(Type)), max_size);
+    }
+
+    // Изменяет размер файла и отображения под new_capacity элементов.
+    // Адрес отображения может измениться
+    void Remap(size_t new_capacity) {
+        const size_t new_bytes = sizeof(Header) + new_capacity * sizeof(Type);
+        if (new_bytes > mapped_bytes_ && ::ftruncate(fd_, static_cast<off_t>(new_bytes)) != 0) {
+            ThrowSystemError("ftruncate"s);
+        }
+#ifdef __linux__
+        void* address = ::mremap(header_, mapped_bytes_, new_bytes, MREMAP_MAYMOVE);
+#else
+        void* address = ::mmap(nullptr, new_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+#endif
+        if (address == MAP_FAILED) {
+            ThrowSystemError("mremap"s);
+        }
+#ifndef __linux__
+        ::munmap(header_, mapped_bytes_);
+#endif
+        header_ = static_cast<Header*>(address);
+        if (new_bytes < mapped_bytes_ && ::ftruncate(fd_, static_cast<off_t>(new_bytes)) != 0) {
+            mapped_bytes_ = new_bytes;
+            ThrowSystemError("ftruncate"s);
+        }
+        mapped_bytes_ = new_bytes;
+    }
+};
+
+template <typename Type, typename GrowthPolicy>
+bool operator==(const MappedSimpleVector<Type, GrowthPolicy>& lhs, const MappedSimpleVector<Type, GrowthPolicy>& rhs) {
+    return SimpleVectorView<const Type>(lhs) == SimpleVectorView<const Type>(rhs);
+}
+
+template <typename Type, typename GrowthPolicy>
+bool operator!=(const MappedSimpleVector<Type, GrowthPolicy>& lhs, const MappedSimpleVector<Type, GrowthPolicy>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type, typename GrowthPolicy>
+bool operator<(const MappedSimpleVector<Type, GrowthPolicy>& lhs, const MappedSimpleVector<Type, GrowthPolicy>& rhs) {
+    return SimpleVectorView<const Type>(lhs) < SimpleVectorView<const Type>(rhs);
+}
+
+template <typename Type, typename GrowthPolicy>
+bool operator<=(const MappedSimpleVector<Type, GrowthPolicy>& lhs, const MappedSimpleVector<Type, GrowthPolicy>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename Type, typename GrowthPolicy>
+bool operator>(const MappedSimpleVector<Type, GrowthPolicy>& lhs, const MappedSimpleVector<Type, GrowthPolicy>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Type, typename GrowthPolicy>
+bool operator>=(const MappedSimpleVector<Type, GrowthPolicy>& lhs, const MappedSimpleVector<Type, GrowthPolicy>& rhs) {
+    return !(lhs < rhs);
+}
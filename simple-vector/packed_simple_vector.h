@@ -0,0 +1,282 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "hardening.h"
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+using namespace std::literals;
+
+// Итератор по значениям PackedSimpleVector. Значения не хранятся в памяти
+// распакованными, поэтому разыменование возвращает копию
+template <typename Packed>
+class PackedIterator {
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = typename Packed::ValueType;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = value_type;
+
+    PackedIterator() noexcept = default;
+
+    PackedIterator(const Packed* owner, size_t index) noexcept
+        : owner_(owner)
+        , index_(index) {
+    }
+
+    value_type operator*() const noexcept {
+        return (*owner_)[index_];
+    }
+
+    PackedIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    PackedIterator operator++(int) noexcept {
+        PackedIterator old = *this;
+        ++index_;
+        return old;
+    }
+
+    friend bool operator==(const PackedIterator& lhs, const PackedIterator& rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+
+    friend bool operator!=(const PackedIterator& lhs, const PackedIterator& rhs) noexcept {
+        return lhs.index_ != rhs.index_;
+    }
+
+private:
+    const Packed* owner_ = nullptr;
+    size_t index_ = 0;
+};
+
+// Вектор беззнаковых целых, сжатый блоками по kBlockSize значений. Блок хранит
+// наименьшее значение (frame of reference) и разности с ним, упакованные
+// одинаковым для всего блока числом бит — сколько нужно для наибольшей разности.
+// Отсортированные идентификаторы с небольшим разбросом в блоке занимают так в
+// несколько раз меньше памяти, чем SimpleVector<UInt>. Ширина значений в блоке
+// постоянна, поэтому operator[] распаковывает одно значение за O(1), а
+// DecodeTo распаковывает весь вектор поблочно без ветвлений на каждое значение.
+// Новые значения копятся в неупакованном хвосте и упаковываются, когда он заполняет блок
+template <typename UInt>
+class PackedSimpleVector {
+    static_assert(std::is_unsigned_v<UInt> && sizeof(UInt) <= sizeof(uint64_t),
+                  "PackedSimpleVector stores unsigned integers up to 64 bits");
+
+    struct BlockHeader {
+        UInt base;
+        uint8_t bit_width;
+        size_t word_offset;
+    };
+
+public:
+    using ValueType = UInt;
+    using ConstIterator = PackedIterator<PackedSimpleVector>;
+
+    static constexpr size_t kBlockSize = 128;
+
+    PackedSimpleVector() = default;
+
+    PackedSimpleVector(std::initializer_list<UInt> init)
+        : PackedSimpleVector(SimpleVectorView<const UInt>(init.begin(), init.size())) {
+    }
+
+    // Упаковывает значения values
+    explicit PackedSimpleVector(SimpleVectorView<const UInt> values) {
+        Append(values);
+    }
+
+    size_t GetSize() const noexcept {
+        return blocks_.GetSize() * kBlockSize + tail_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    UInt operator[](size_t index) const noexcept {
+        SIMPLE_VECTOR_CHECK(index < GetSize(), "index out of range");
+        const size_t block = index / kBlockSize;
+        if (block == blocks_.GetSize()) {
+            return tail_[index % kBlockSize];
+        }
+        const BlockHeader& header = blocks_[block];
+        if (header.bit_width == 0) {
+            return header.base;
+        }
+        return header.base + static_cast<UInt>(Extract(words_.Data() + header.word_offset, header.bit_width,
+                                                       index % kBlockSize));
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    UInt At(size_t index) const {
+        if (index >= GetSize()) {
+            throw std::out_of_range("index out of range"s);
+        }
+        return (*this)[index];
+    }
+
+    ConstIterator begin() const noexcept {
+        return ConstIterator(this, 0);
+    }
+
+    ConstIterator end() const noexcept {
+        return ConstIterator(this, GetSize());
+    }
+
+    // Если упаковать заполненный хвост не удалось, значение не добавляется,
+    // и хвост остаётся не длиннее блока
+    void PushBack(UInt value) {
+        tail_.PushBack(value);
+        if (tail_.GetSize() == kBlockSize) {
+            try {
+                PackBlock(tail_.Data());
+            } catch (...) {
+                tail_.PopBack();
+                throw;
+            }
+            tail_.Clear();
+        }
+    }
+
+    // Добавляет значения values. Полные блоки упаковываются прямо из values
+    void Append(SimpleVectorView<const UInt> values) {
+        size_t offset = 0;
+        while (offset < values.GetSize() && !tail_.IsEmpty()) {
+            PushBack(values[offset++]);
+        }
+        for (; values.GetSize() - offset >= kBlockSize; offset += kBlockSize) {
+            PackBlock(values.Data() + offset);
+        }
+        for (; offset < values.GetSize(); ++offset) {
+            PushBack(values[offset]);
+        }
+    }
+
+    // Заменяет элементы out распакованными значениями вектора
+    template <typename Allocator, typename GrowthPolicy>
+    void DecodeTo(SimpleVector<UInt, Allocator, GrowthPolicy>& out) const {
+        out.Clear();
+        out.AppendConstructed(GetSize(), [this](Allocator&, UInt* dest, size_t) {
+            for (const BlockHeader& header : blocks_) {
+                DecodeBlock(header, dest);
+                dest += kBlockSize;
+            }
+            std::copy(tail_.begin(), tail_.end(), dest);
+        });
+    }
+
+    void Clear() noexcept {
+        blocks_.Clear();
+        words_.Clear();
+        tail_.Clear();
+    }
+
+    // Возвращает, сколько байт выделено под упакованные значения и заголовки
+    // блоков и сколько из них занято
+    VectorMemoryUsage MemoryUsage() const noexcept {
+        VectorMemoryUsage usage;
+        for (const VectorMemoryUsage part : {blocks_.MemoryUsage(), words_.MemoryUsage(), tail_.MemoryUsage()}) {
+            usage.reserved_bytes += part.reserved_bytes;
+            usage.used_bytes += part.used_bytes;
+        }
+        return usage;
+    }
+
+    // Число бит на значение в блоке block
+    size_t GetBlockBitWidth(size_t block) const noexcept {
+        SIMPLE_VECTOR_CHECK(block < blocks_.GetSize(), "block out of range");
+        return blocks_[block].bit_width;
+    }
+
+private:
+    SimpleVector<BlockHeader> blocks_;
+    // Упакованные блоки по kWordsPerBit * bit_width слов и одно нулевое слово
+    // в конце, чтобы значение на границе слов читалось без ветвления. Блок
+    // нулевой ширины слов не занимает, и его значения из words_ не читаются
+    SimpleVector<uint64_t> words_;
+    SimpleVector<UInt> tail_;
+
+    // Блок из kBlockSize значений шириной bit_width занимает целое число слов
+    static constexpr size_t kWordsPerBit = kBlockSize / 64;
+    static_assert(kBlockSize % 64 == 0, "block must fill whole words at any bit width");
+
+    static uint64_t LowBits(size_t bit_width) noexcept {
+        return bit_width == 64 ? ~uint64_t{0} : (uint64_t{1} << bit_width) - 1;
+    }
+
+    static size_t BitWidth(uint64_t range) noexcept {
+        size_t width = 0;
+        while (width < 64 && (range >> width) != 0) {
+            ++width;
+        }
+        return width;
+    }
+
+    // Читает значение position из блока с ненулевой шириной bit_width,
+    // начинающегося с words
+    static uint64_t Extract(const uint64_t* words, size_t bit_width, size_t position) noexcept {
+        const size_t bit = position * bit_width;
+        const size_t shift = bit % 64;
+        const uint64_t low = words[bit / 64] >> shift;
+        // Сдвиг в два шага не даёт сдвинуть на 64 при shift == 0
+        const uint64_t high = (words[bit / 64 + 1] << (63 - shift)) << 1;
+        return (low | high) & LowBits(bit_width);
+    }
+
+    void DecodeBlock(const BlockHeader& header, UInt* dest) const noexcept {
+        if (header.bit_width == 0) {
+            std::fill(dest, dest + kBlockSize, header.base);
+            return;
+        }
+        const uint64_t* words = words_.Data() + header.word_offset;
+        for (size_t i = 0; i < kBlockSize; ++i) {
+            dest[i] = header.base + static_cast<UInt>(Extract(words, header.bit_width, i));
+        }
+    }
+
+    void PackBlock(const UInt* values) {
+        const auto [min, max] = std::minmax_element(values, values + kBlockSize);
+        const UInt base = *min;
+        const size_t bit_width = BitWidth(static_cast<uint64_t>(*max - base));
+        if (words_.IsEmpty()) {
+            words_.PushBack(0);
+        }
+        // Последнее слово — нулевое дополнение, с него начинается новый блок
+        const size_t word_offset = words_.GetSize() - 1;
+        blocks_.Reserve(blocks_.GetSize() + 1);
+        words_.Resize(words_.GetSize() + kWordsPerBit * bit_width);
+        uint64_t* words = words_.Data() + word_offset;
+        for (size_t i = 0; i < kBlockSize && bit_width != 0; ++i) {
+            const uint64_t delta = static_cast<uint64_t>(values[i] - base);
+            const size_t bit = i * bit_width;
+            const size_t shift = bit % 64;
+            words[bit / 64] |= delta << shift;
+            if (shift + bit_width > 64) {
+                words[bit / 64 + 1] |= delta >> (64 - shift);
+            }
+        }
+        blocks_.PushBack({base, static_cast<uint8_t>(bit_width), word_offset});
+    }
+};
+
+template <typename UInt>
+bool operator==(const PackedSimpleVector<UInt>& lhs, const PackedSimpleVector<UInt>& rhs) {
+    return lhs.GetSize() == rhs.GetSize() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename UInt>
+bool operator!=(const PackedSimpleVector<UInt>& lhs, const PackedSimpleVector<UInt>& rhs) {
+    return !(lhs == rhs);
+}
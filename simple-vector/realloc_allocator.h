@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+// Аллокатор на malloc, realloc и free. Вектор тривиально переносимых элементов
+// с этим аллокатором растёт через reallocate, не копируя элементы сам: realloc
+// расширяет блок на месте, если за ним есть свободная память, а большие блоки
+// (glibc выделяет их через mmap) переносит вызовом mremap, переотображая страницы
+template <typename Type>
+class ReallocAllocator {
+    static_assert(alignof(Type) <= alignof(std::max_align_t), "malloc does not guarantee extended alignment");
+
+public:
+    using value_type = Type;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    ReallocAllocator() noexcept = default;
+
+    template <typename Other>
+    ReallocAllocator(const ReallocAllocator<Other>& /*other*/) noexcept {
+    }
+
+    [[nodiscard]] Type* allocate(size_t count) {
+        if (count > std::numeric_limits<size_t>::max() / sizeof(Type)) {
+            throw std::bad_array_new_length();
+        }
+        void* block = std::malloc(count * sizeof(Type));
+        if (block == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<Type*>(block);
+    }
+
+    void deallocate(Type* ptr, size_t /*count*/) noexcept {
+        std::free(ptr);
+    }
+
+    // Меняет размер блока ptr из old_count элементов на new_count, сохраняя байты
+    // первых элементов. Блок может переехать, поэтому так можно переносить только
+    // тривиально переносимые объекты. Возвращает nullptr, если памяти не хватило;
+    // тогда блок остаётся прежним
+    [[nodiscard]] Type* reallocate(Type* ptr, size_t /*old_count*/, size_t new_count) noexcept {
+        if (new_count > std::numeric_limits<size_t>::max() / sizeof(Type)) {
+            return nullptr;
+        }
+        return static_cast<Type*>(std::realloc(ptr, new_count * sizeof(Type)));
+    }
+};
+
+template <typename Lhs, typename Rhs>
+bool operator==(const ReallocAllocator<Lhs>&, const ReallocAllocator<Rhs>&) noexcept {
+    return true;
+}
+
+template <typename Lhs, typename Rhs>
+bool operator!=(const ReallocAllocator<Lhs>&, const ReallocAllocator<Rhs>&) noexcept {
+    return false;
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "uninitialized.h"
+
+// Сообщает, что объект типа Type можно перенести в другую память побайтовым
+// копированием, не вызывая конструктор перемещения и деструктор исходного объекта.
+// По умолчанию это верно для тривиально копируемых типов; для своего типа
+// (например, владеющего указателем без ссылок на самого себя) можно включить явно:
+//     template <>
+//     struct IsTriviallyRelocatable<MyType> : std::true_type {};
+template <typename Type>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<Type> {
+};
+
+template <typename Type>
+inline constexpr bool IsTriviallyRelocatableV = IsTriviallyRelocatable<Type>::value;
+
+// Перемещать элементы при переносе можно, если перемещение не бросает исключений
+// или если тип нельзя скопировать (как std::move_if_noexcept). Иначе они копируются,
+// чтобы исходный диапазон остался нетронутым, если перенос прервётся исключением
+template <typename Type>
+inline constexpr bool IsRelocatedByMoveV =
+    std::is_nothrow_move_constructible_v<Type> || !std::is_copy_constructible_v<Type>;
+
+// Создаёт в неинициализированной памяти dest копии count элементов,
+// начиная с first, не разрушая исходные объекты.
+// Если Type тривиально переносим, копирует память одним вызовом memcpy
+// Во время компиляции элементы всегда переносятся поэлементно
+template <typename Allocator, typename Type>
+SIMPLE_VECTOR_CONSTEXPR void UninitializedRelocateN(Allocator& alloc, Type* first, size_t count, Type* dest) {
+    if (IsTriviallyRelocatableV<Type> && !IsConstantEvaluated()) {
+        if (count != 0) {
+            std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), count * sizeof(Type));
+        }
+    } else if constexpr (IsRelocatedByMoveV<Type>) {
+        UninitializedMoveN(alloc, first, count, dest);
+    } else {
+        UninitializedCopyN(alloc, first, count, dest);
+    }
+}
+
+// Завершает перенос, начатый UninitializedRelocateN: разрушает исходные объекты.
+// Для тривиально переносимых типов деструкторы не вызываются — объекты уже
+// принадлежат новой памяти
+template <typename Allocator, typename Type>
+SIMPLE_VECTOR_CONSTEXPR void DestroyRelocatedN(Allocator& alloc, Type* first, size_t count) noexcept {
+    if (!IsTriviallyRelocatableV<Type> || IsConstantEvaluated()) {
+        DestroyN(alloc, first, count);
+    }
+}
+
+// Переносит count элементов из first в неинициализированную память dest.
+// После успешного переноса память исходного диапазона неинициализирована.
+// Если перенос прерван исключением, исходный диапазон не изменяется
+template <typename Allocator, typename Type>
+SIMPLE_VECTOR_CONSTEXPR void RelocateN(Allocator& alloc, Type* first, size_t count, Type* dest) {
+    UninitializedRelocateN(alloc, first, count, dest);
+    DestroyRelocatedN(alloc, first, count);
+}
+
+// Сдвигает элементы [pos, end) на count позиций вправо в пределах одного
+// буфера, освобождая место под вставку. Память [end, end + count) должна быть
+// неинициализированной; после сдвига неинициализированной становится
+// память [pos, pos + count), а элементы находятся в [pos + count, end + count).
+// Если сдвиг прерван исключением, элементы остаются в [pos, end)
+template <typename Allocator, typename Type>
+SIMPLE_VECTOR_CONSTEXPR void OpenGap(Allocator& alloc, Type* pos, Type* end, size_t count) {
+    if (count == 0 || pos == end) {
+        return;
+    }
+    const size_t tail = static_cast<size_t>(end - pos);
+    if (IsTriviallyRelocatableV<Type> && !IsConstantEvaluated()) {
+        std::memmove(static_cast<void*>(pos + count), static_cast<const void*>(pos), tail * sizeof(Type));
+    } else {
+        // В неинициализированную память за концом переносятся последние элементы,
+        // остальные сдвигаются присваиванием внутри уже созданных объектов
+        const size_t to_raw = std::min(count, tail);
+        UninitializedMoveN(alloc, end - to_raw, to_raw, end + count - to_raw);
+        try {
+            std::move_backward(pos, end - to_raw, end);
+        } catch (...) {
+            DestroyN(alloc, end + count - to_raw, to_raw);
+            throw;
+        }
+        DestroyN(alloc, pos, to_raw);
+    }
+}
+
+// Обратная к OpenGap операция: память [pos, pos + count) неинициализирована,
+// элементы находятся в [pos + count, end). Сдвигает их на count позиций влево,
+// после чего неинициализированной становится память [end - count, end)
+template <typename Allocator, typename Type>
+SIMPLE_VECTOR_CONSTEXPR void CloseGap(Allocator& alloc, Type* pos, Type* end, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    const size_t tail = static_cast<size_t>(end - pos) - count;
+    if (IsTriviallyRelocatableV<Type> && !IsConstantEvaluated()) {
+        if (tail != 0) {
+            std::memmove(static_cast<void*>(pos), static_cast<const void*>(pos + count), tail * sizeof(Type));
+        }
+    } else {
+        const size_t to_raw = std::min(count, tail);
+        UninitializedMoveN(alloc, pos + count, to_raw, pos);
+        std::move(pos + count + to_raw, end, pos + to_raw);
+        // Разрушаются исходные объекты, оказавшиеся за новым концом. Если элементов
+        // было меньше count, часть памяти за ними осталась неинициализированной
+        const size_t first_stale = std::max(tail, count);
+        DestroyN(alloc, pos + first_stale, static_cast<size_t>(end - pos) - first_stale);
+    }
+}
+
+// Удаляет элементы [pos, pos + count) из диапазона [pos, end), сдвигая хвост
+// на их место; после удаления неинициализированной становится память
+// [end - count, end). Тривиально переносимые элементы разрушаются и сдвигаются
+// одним memmove. Остальные сдвигаются присваиванием перемещением, а разрушаются
+// только объекты за новым концом: если присваивание выбросит исключение, ни один
+// объект ещё не разрушен, и все count + хвост элементов остаются созданными
+// (часть — в перемещённом состоянии)
+template <typename Allocator, typename Type>
+SIMPLE_VECTOR_CONSTEXPR void EraseN(Allocator& alloc, Type* pos, Type* end, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (IsTriviallyRelocatableV<Type> && !IsConstantEvaluated()) {
+        DestroyN(alloc, pos, count);
+        CloseGap(alloc, pos, end, count);
+    } else {
+        std::move(pos + count, end, pos);
+        DestroyN(alloc, end - count, count);
+    }
+}
+
+// Удаляет из [first, last) элементы, для которых pred истинен, сохраняя порядок
+// остальных: каждый оставшийся элемент перемещается не больше одного раза, а
+// объекты за новым концом разрушаются. Возвращает новый конец диапазона.
+// Если pred выбросит исключение, ничего не разрушается, но часть элементов
+// может остаться в перемещённом состоянии
+template <typename Allocator, typename Type, typename Predicate>
+SIMPLE_VECTOR_CONSTEXPR Type* CompactIf(Allocator& alloc, Type* first, Type* last, Predicate& pred) {
+    Type* out = first;
+    for (Type* it = first; it != last; ++it) {
+        if (!pred(*it)) {
+            if (out != it) {
+                *out = std::move(*it);
+            }
+            ++out;
+        }
+    }
+    DestroyN(alloc, out, static_cast<size_t>(last - out));
+    return out;
+}
+
+// Удаляет из first[0, size) элементы с индексами indices[0, count), которые
+// строго возрастают: участки между удаляемыми сдвигаются к началу по одному
+// разу, а объекты за новым концом разрушаются. Возвращает новый конец диапазона
+template <typename Allocator, typename Type>
+SIMPLE_VECTOR_CONSTEXPR Type* CompactIndices(Allocator& alloc, Type* first, size_t size, const size_t* indices,
+                                             size_t count) {
+    if (count == 0) {
+        return first + size;
+    }
+    Type* out = first + indices[0];
+    for (size_t k = 0; k < count; ++k) {
+        const size_t kept_begin = indices[k] + 1;
+        const size_t kept_end = k + 1 < count ? indices[k + 1] : size;
+        out = std::move(first + kept_begin, first + kept_end, out);
+    }
+    DestroyN(alloc, out, static_cast<size_t>(first + size - out));
+    return out;
+}
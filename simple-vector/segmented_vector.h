@@ -0,0 +1,555 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "hardening.h"
+#include "simple_vector.h"
+#include "uninitialized.h"
+
+using namespace std::literals;
+
+// Число элементов в блоке SegmentedVector по умолчанию: наибольшая степень двойки,
+// при которой блок занимает не больше 64 КиБ
+template <typename Type>
+constexpr size_t DefaultChunkSize() noexcept {
+    size_t size = 1;
+    while (size * 2 * sizeof(Type) <= 64 * 1024) {
+        size *= 2;
+    }
+    return size;
+}
+
+// Итератор произвольного доступа по элементам SegmentedVector: хранит таблицу
+// блоков и индекс элемента, поэтому переход на любое расстояние занимает O(1)
+template <typename Type, size_t ChunkSize, bool IsConst>
+class SegmentedIterator {
+    using ChunkPointer = std::conditional_t<IsConst, const Type*, Type*>;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = Type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = ChunkPointer;
+    using reference = std::conditional_t<IsConst, const Type&, Type&>;
+
+    SegmentedIterator() = default;
+
+    SegmentedIterator(Type* const* chunks, size_t index) noexcept
+        : chunks_(chunks)
+        , index_(index) {
+    }
+
+    // Неконстантный итератор преобразуется в константный
+    template <bool OtherIsConst, std::enable_if_t<IsConst && !OtherIsConst, int> = 0>
+    SegmentedIterator(const SegmentedIterator<Type, ChunkSize, OtherIsConst>& other) noexcept
+        : chunks_(other.chunks_)
+        , index_(other.index_) {
+    }
+
+    reference operator*() const noexcept {
+        return chunks_[index_ / ChunkSize][index_ % ChunkSize];
+    }
+
+    pointer operator->() const noexcept {
+        return &**this;
+    }
+
+    reference operator[](difference_type offset) const noexcept {
+        return *(*this + offset);
+    }
+
+    SegmentedIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    SegmentedIterator operator++(int) noexcept {
+        SegmentedIterator old = *this;
+        ++index_;
+        return old;
+    }
+
+    SegmentedIterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+
+    SegmentedIterator operator--(int) noexcept {
+        SegmentedIterator old = *this;
+        --index_;
+        return old;
+    }
+
+    SegmentedIterator& operator+=(difference_type offset) noexcept {
+        index_ += offset;
+        return *this;
+    }
+
+    SegmentedIterator& operator-=(difference_type offset) noexcept {
+        index_ -= offset;
+        return *this;
+    }
+
+    friend SegmentedIterator operator+(SegmentedIterator it, difference_type offset) noexcept {
+        return it += offset;
+    }
+
+    friend SegmentedIterator operator+(difference_type offset, SegmentedIterator it) noexcept {
+        return it += offset;
+    }
+
+    friend SegmentedIterator operator-(SegmentedIterator it, difference_type offset) noexcept {
+        return it -= offset;
+    }
+
+    friend difference_type operator-(const SegmentedIterator& lhs, const SegmentedIterator& rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    friend bool operator==(const SegmentedIterator& lhs, const SegmentedIterator& rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+
+    friend bool operator!=(const SegmentedIterator& lhs, const SegmentedIterator& rhs) noexcept {
+        return lhs.index_ != rhs.index_;
+    }
+
+    friend bool operator<(const SegmentedIterator& lhs, const SegmentedIterator& rhs) noexcept {
+        return lhs.index_ < rhs.index_;
+    }
+
+    friend bool operator>(const SegmentedIterator& lhs, const SegmentedIterator& rhs) noexcept {
+        return rhs < lhs;
+    }
+
+    friend bool operator<=(const SegmentedIterator& lhs, const SegmentedIterator& rhs) noexcept {
+        return !(rhs < lhs);
+    }
+
+    friend bool operator>=(const SegmentedIterator& lhs, const SegmentedIterator& rhs) noexcept {
+        return !(lhs < rhs);
+    }
+
+private:
+    template <typename, size_t, bool>
+    friend class SegmentedIterator;
+
+    Type* const* chunks_ = nullptr;
+    size_t index_ = 0;
+};
+
+// Вектор из блоков по ChunkSize элементов. Рост добавляет новый блок и не переносит
+// уже созданные элементы, поэтому их адреса не меняются, а для роста не нужна
+// память под копию всего массива. Доступ по индексу — через таблицу блоков за O(1).
+// Как у std::deque, добавление элементов может сделать итераторы недействительными
+// (таблица блоков перевыделяется), но не ссылки и указатели на элементы.
+// Вставки и удаления в середине нет: они сдвигали бы элементы
+template <typename Type, size_t ChunkSize = DefaultChunkSize<Type>(), typename Allocator = std::allocator<Type>>
+class SegmentedVector {
+    static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0, "chunk size must be a power of two");
+
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using ChunkTable = SimpleVector<Type*, typename AllocTraits::template rebind_alloc<Type*>>;
+
+    static constexpr bool kPropagateOnCopy = AllocTraits::propagate_on_container_copy_assignment::value;
+    static constexpr bool kPropagateOnMove = AllocTraits::propagate_on_container_move_assignment::value;
+    static constexpr bool kPropagateOnSwap = AllocTraits::propagate_on_container_swap::value;
+
+public:
+    using Iterator = SegmentedIterator<Type, ChunkSize, false>;
+    using ConstIterator = SegmentedIterator<Type, ChunkSize, true>;
+    using AllocatorType = Allocator;
+
+    static constexpr size_t kChunkSize = ChunkSize;
+
+    SegmentedVector() = default;
+
+    explicit SegmentedVector(const Allocator& alloc) noexcept
+        : alloc_(alloc)
+        , chunks_(typename ChunkTable::AllocatorType(alloc)) {
+    }
+
+    // Создаёт вектор из size элементов, инициализированных значением по умолчанию
+    explicit SegmentedVector(size_t size, const Allocator& alloc = Allocator())
+        : SegmentedVector(alloc) {
+        Resize(size);
+    }
+
+    // Создаёт вектор из size элементов, инициализированных значением value
+    SegmentedVector(size_t size, const Type& value, const Allocator& alloc = Allocator())
+        : SegmentedVector(alloc) {
+        AppendConstructed(size, [&value](Allocator& a, Type* dest, size_t count) {
+            UninitializedFillN(a, dest, count, value);
+        });
+    }
+
+    SegmentedVector(std::initializer_list<Type> init, const Allocator& alloc = Allocator())
+        : SegmentedVector(init.begin(), init.end(), alloc) {
+    }
+
+    // Создаёт вектор из элементов диапазона [first, last)
+    template <typename InputIt, EnableIfInputIterator<InputIt> = 0>
+    SegmentedVector(InputIt first, InputIt last, const Allocator& alloc = Allocator())
+        : SegmentedVector(alloc) {
+        Append(first, last);
+    }
+
+    // Копия получает аллокатор, который выбирает select_on_container_copy_construction
+    SegmentedVector(const SegmentedVector& other)
+        : SegmentedVector(other, AllocTraits::select_on_container_copy_construction(other.alloc_)) {
+    }
+
+    SegmentedVector(const SegmentedVector& other, const Allocator& alloc)
+        : SegmentedVector(alloc) {
+        Reserve(other.size_);
+        other.ForEachChunk([this](const Type* items, size_t count) {
+            AppendConstructed(count, [items](Allocator& a, Type* dest, size_t n) mutable {
+                UninitializedCopyN(a, items, n, dest);
+                items += n;
+            });
+        });
+    }
+
+    // Забирает блоки other, не трогая элементы
+    SegmentedVector(SegmentedVector&& other) noexcept
+        : alloc_(std::move(other.alloc_))
+        , chunks_(std::move(other.chunks_))
+        , size_(std::exchange(other.size_, 0)) {
+    }
+
+    // Забирает блоки other, если аллокаторы равны, иначе перемещает элементы
+    // по одному в блоки, выделенные alloc
+    SegmentedVector(SegmentedVector&& other, const Allocator& alloc)
+        : SegmentedVector(alloc) {
+        if (alloc_ == other.alloc_) {
+            chunks_.swap(other.chunks_);
+            std::swap(size_, other.size_);
+        } else {
+            Append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+        }
+    }
+
+    ~SegmentedVector() {
+        Clear();
+        ReleaseChunks(0);
+    }
+
+    SegmentedVector& operator=(const SegmentedVector& rhs) {
+        if (this != &rhs) {
+            SegmentedVector tmp(rhs, kPropagateOnCopy ? rhs.alloc_ : alloc_);
+            SwapStorage(tmp);
+        }
+        return *this;
+    }
+
+    SegmentedVector& operator=(SegmentedVector&& rhs) noexcept(kPropagateOnMove ||
+                                                                AllocTraits::is_always_equal::value) {
+        if (this != &rhs) {
+            if (kPropagateOnMove || alloc_ == rhs.alloc_) {
+                SegmentedVector tmp(std::move(rhs));
+                SwapStorage(tmp);
+            } else {
+                SegmentedVector tmp(std::move(rhs), alloc_);
+                SwapStorage(tmp);
+            }
+        }
+        return *this;
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Возвращает количество элементов в векторе
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    // Возвращает количество элементов в выделенных блоках
+    size_t GetCapacity() const noexcept {
+        return chunks_.GetSize() * ChunkSize;
+    }
+
+    // Возвращает количество выделенных блоков
+    size_t GetChunkCount() const noexcept {
+        return chunks_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    Type& operator[](size_t index) noexcept {
+        SIMPLE_VECTOR_CHECK(index < size_, "index out of range");
+        return chunks_[index / ChunkSize][index % ChunkSize];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        SIMPLE_VECTOR_CHECK(index < size_, "index out of range");
+        return chunks_[index / ChunkSize][index % ChunkSize];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("index out of range"s);
+        }
+        return (*this)[index];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("index out of range"s);
+        }
+        return (*this)[index];
+    }
+
+    // Выделяет блоки, чтобы вместимость стала не меньше new_capacity
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > GetCapacity()) {
+            const size_t chunk_count = (new_capacity + ChunkSize - 1) / ChunkSize;
+            chunks_.Reserve(chunk_count);
+            while (chunks_.GetSize() < chunk_count) {
+                AddChunk();
+            }
+        }
+    }
+
+    // Освобождает блоки, в которых нет элементов
+    void ShrinkToFit() noexcept {
+        ReleaseChunks((size_ + ChunkSize - 1) / ChunkSize);
+    }
+
+    // Разрушает элементы, не освобождая блоки
+    void Clear() noexcept {
+        DestroyTail(0);
+    }
+
+    // Изменяет размер вектора. Новые элементы получают значение по умолчанию
+    void Resize(size_t new_size) {
+        if (new_size <= size_) {
+            DestroyTail(new_size);
+            return;
+        }
+        AppendConstructed(new_size - size_, [](Allocator& a, Type* dest, size_t count) {
+            UninitializedValueConstructN(a, dest, count);
+        });
+    }
+
+    // Создаёт элемент в конце вектора из аргументов args и возвращает ссылку на него.
+    // Если места в блоках нет, добавляется новый блок
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        if (size_ == GetCapacity()) {
+            AddChunk();
+        }
+        Type* slot = SlotAt(size_);
+        Construct(alloc_, slot, std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    // "Удаляет" последний элемент вектора. Вектор не должен быть пустым
+    void PopBack() noexcept {
+        SIMPLE_VECTOR_CHECK(size_ != 0, "PopBack on empty vector");
+        DestroyTail(size_ - 1);
+    }
+
+    // Добавляет в конец вектора элементы диапазона [first, last). Элементы
+    // непрерывных диапазонов копируются в блоки целыми отрезками
+    template <typename InputIt, EnableIfInputIterator<InputIt> = 0>
+    void Append(InputIt first, InputIt last) {
+        if constexpr (IsForwardIteratorV<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            Reserve(size_ + count);
+            AppendConstructed(count, [&first](Allocator& a, Type* dest, size_t n) {
+                UninitializedCopyN(a, first, n, dest);
+                std::advance(first, n);
+            });
+        } else {
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+    }
+
+    // Обменивает содержимое с другим вектором. Блоки не копируются
+    void swap(SegmentedVector& other) noexcept {
+        assert(kPropagateOnSwap || alloc_ == other.alloc_);
+        SwapStorage(other);
+    }
+
+    // Возвращает непрерывную копию вектора
+    SimpleVector<Type, Allocator> Flatten() const& {
+        SimpleVector<Type, Allocator> result(ReserveProxyObj(size_), alloc_);
+        ForEachChunk([&result](const Type* items, size_t count) {
+            result.Append(items, items + count);
+        });
+        return result;
+    }
+
+    // Перемещает элементы в непрерывный вектор
+    SimpleVector<Type, Allocator> Flatten() && {
+        SimpleVector<Type, Allocator> result(ReserveProxyObj(size_), alloc_);
+        ForEachChunk([&result](Type* items, size_t count) {
+            result.Append(std::make_move_iterator(items), std::make_move_iterator(items + count));
+        });
+        Clear();
+        return result;
+    }
+
+    // Вызывает process(items, count) для каждого непрерывного отрезка элементов по порядку
+    template <typename ProcessChunk>
+    void ForEachChunk(ProcessChunk process) {
+        for (size_t begin = 0; begin < size_; begin += ChunkSize) {
+            process(chunks_[begin / ChunkSize], std::min(ChunkSize, size_ - begin));
+        }
+    }
+
+    template <typename ProcessChunk>
+    void ForEachChunk(ProcessChunk process) const {
+        for (size_t begin = 0; begin < size_; begin += ChunkSize) {
+            process(static_cast<const Type*>(chunks_[begin / ChunkSize]), std::min(ChunkSize, size_ - begin));
+        }
+    }
+
+    Iterator begin() noexcept {
+        return Iterator(chunks_.Data(), 0);
+    }
+
+    Iterator end() noexcept {
+        return Iterator(chunks_.Data(), size_);
+    }
+
+    ConstIterator begin() const noexcept {
+        return ConstIterator(chunks_.Data(), 0);
+    }
+
+    ConstIterator end() const noexcept {
+        return ConstIterator(chunks_.Data(), size_);
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    [[no_unique_address]] Allocator alloc_;
+    ChunkTable chunks_;
+    size_t size_ = 0;
+
+    Type* SlotAt(size_t index) noexcept {
+        return chunks_[index / ChunkSize] + index % ChunkSize;
+    }
+
+    // Выделяет новый блок и добавляет его в таблицу
+    void AddChunk() {
+        Type* chunk = AllocTraits::allocate(alloc_, ChunkSize);
+        try {
+            chunks_.PushBack(chunk);
+        } catch (...) {
+            AllocTraits::deallocate(alloc_, chunk, ChunkSize);
+            throw;
+        }
+    }
+
+    // Освобождает блоки с номера first_chunk. В них не должно быть элементов
+    void ReleaseChunks(size_t first_chunk) noexcept {
+        while (chunks_.GetSize() > first_chunk) {
+            AllocTraits::deallocate(alloc_, chunks_[chunks_.GetSize() - 1], ChunkSize);
+            chunks_.PopBack();
+        }
+    }
+
+    // Разрушает элементы с индекса new_size до конца
+    void DestroyTail(size_t new_size) noexcept {
+        while (size_ > new_size) {
+            const size_t chunk_begin = std::max(new_size, (size_ - 1) / ChunkSize * ChunkSize);
+            DestroyN(alloc_, SlotAt(chunk_begin), size_ - chunk_begin);
+            size_ = chunk_begin;
+        }
+    }
+
+    // Добавляет count элементов, создавая их по отрезкам блоков вызовом
+    // construct(alloc, dest, n), который при исключении сам разрушает созданные им элементы.
+    // Созданные до исключения отрезки остаются в векторе
+    template <typename ConstructFn>
+    void AppendConstructed(size_t count, ConstructFn construct) {
+        Reserve(size_ + count);
+        while (count != 0) {
+            const size_t n = std::min(count, ChunkSize - size_ % ChunkSize);
+            construct(alloc_, SlotAt(size_), n);
+            size_ += n;
+            count -= n;
+        }
+    }
+
+    // Обменивает блоки, размер и, если это возможно, аллокаторы
+    void SwapStorage(SegmentedVector& other) noexcept {
+        if constexpr (std::is_swappable_v<Allocator>) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        } else {
+            assert(alloc_ == other.alloc_);
+        }
+        chunks_.swap(other.chunks_);
+        std::swap(size_, other.size_);
+    }
+};
+
+template <typename Type, size_t ChunkSize, typename Allocator>
+bool operator==(const SegmentedVector<Type, ChunkSize, Allocator>& lhs,
+                const SegmentedVector<Type, ChunkSize, Allocator>& rhs) {
+    return lhs.GetSize() == rhs.GetSize() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename Type, size_t ChunkSize, typename Allocator>
+bool operator!=(const SegmentedVector<Type, ChunkSize, Allocator>& lhs,
+                const SegmentedVector<Type, ChunkSize, Allocator>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type, size_t ChunkSize, typename Allocator>
+bool operator<(const SegmentedVector<Type, ChunkSize, Allocator>& lhs,
+               const SegmentedVector<Type, ChunkSize, Allocator>& rhs) {
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type, size_t ChunkSize, typename Allocator>
+bool operator<=(const SegmentedVector<Type, ChunkSize, Allocator>& lhs,
+                const SegmentedVector<Type, ChunkSize, Allocator>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename Type, size_t ChunkSize, typename Allocator>
+bool operator>(const SegmentedVector<Type, ChunkSize, Allocator>& lhs,
+               const SegmentedVector<Type, ChunkSize, Allocator>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Type, size_t ChunkSize, typename Allocator>
+bool operator>=(const SegmentedVector<Type, ChunkSize, Allocator>& lhs,
+                const SegmentedVector<Type, ChunkSize, Allocator>& rhs) {
+    return !(lhs < rhs);
+}
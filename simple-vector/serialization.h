@@ -0,0 +1,365 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+#include "uninitialized.h"
+
+using namespace std::literals;
+
+// Двоичный формат SimpleVector: заголовок SerializationHeader и за ним элементы.
+// Элементы тривиально копируемых типов записываются одним блоком в порядке байтов
+// машины, поэтому читать их можно прямо из буфера (ViewSerialized).
+// Остальные типы записываются поэлементно через точку настройки Serializer<Type>
+
+// Специализация Serializer<Type> задаёт запись и чтение одного элемента:
+//     template <typename Writer> static void Write(Writer& writer, const Type& item);
+//     template <typename Reader> static Type Read(Reader& reader);
+// У Writer есть метод Write(const void* data, size_t size), у Reader — Read(void* data, size_t size)
+template <typename Type, typename = void>
+struct Serializer;
+
+template <typename Type, typename = void>
+struct HasSerializer : std::false_type {
+};
+
+template <typename Type>
+struct HasSerializer<Type, std::void_t<decltype(sizeof(Serializer<Type>))>> : std::true_type {
+};
+
+// Ошибка формата: неверный заголовок или данные закончились раньше времени
+class SerializationError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Заголовок сериализованного вектора. Поля хранятся в порядке little-endian
+struct SerializationHeader {
+    // Порядок байтов элементов
+    enum class ByteOrder : uint8_t {
+        kLittle = 1,
+        kBig = 2,
+    };
+
+    static constexpr uint32_t kMagic = 0x5356'4543;
+    static constexpr uint16_t kVersion = 1;
+    // Размер заголовка в байтах; элементы за ним выровнены на 8 байт
+    static constexpr size_t kSize = 24;
+
+    uint16_t version = kVersion;
+    ByteOrder byte_order = ByteOrder::kLittle;
+    // Размер элемента для блочной записи или 0 для поэлементной через Serializer
+    uint64_t element_size = 0;
+    uint64_t count = 0;
+
+    static ByteOrder NativeByteOrder() noexcept {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return ByteOrder::kBig;
+#else
+        return ByteOrder::kLittle;
+#endif
+    }
+
+    template <typename Writer>
+    void Write(Writer& writer) const {
+        unsigned char bytes[kSize] = {};
+        StoreLittle(bytes, kMagic, 4);
+        StoreLittle(bytes + 4, version, 2);
+        bytes[6] = static_cast<unsigned char>(byte_order);
+        StoreLittle(bytes + 8, element_size, 8);
+        StoreLittle(bytes + 16, count, 8);
+        writer.Write(bytes, kSize);
+    }
+
+    template <typename Reader>
+    static SerializationHeader Read(Reader& reader) {
+        unsigned char bytes[kSize];
+        reader.Read(bytes, kSize);
+        if (LoadLittle(bytes, 4) != kMagic) {
+            throw SerializationError("not a serialized SimpleVector"s);
+        }
+        SerializationHeader header;
+        header.version = static_cast<uint16_t>(LoadLittle(bytes + 4, 2));
+        header.byte_order = static_cast<ByteOrder>(bytes[6]);
+        header.element_size = LoadLittle(bytes + 8, 8);
+        header.count = LoadLittle(bytes + 16, 8);
+        if (header.version != kVersion) {
+            throw SerializationError("unsupported SimpleVector format version "s + std::to_string(header.version));
+        }
+        if (header.byte_order != ByteOrder::kLittle && header.byte_order != ByteOrder::kBig) {
+            throw SerializationError("invalid byte order in SimpleVector header"s);
+        }
+        return header;
+    }
+
+private:
+    static void StoreLittle(unsigned char* dest, uint64_t value, size_t size) noexcept {
+        for (size_t i = 0; i < size; ++i) {
+            dest[i] = static_cast<unsigned char>(value >> (8 * i));
+        }
+    }
+
+    static uint64_t LoadLittle(const unsigned char* src, size_t size) noexcept {
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; ++i) {
+            value |= uint64_t{src[i]} << (8 * i);
+        }
+        return value;
+    }
+};
+
+// Запись в поток
+class StreamWriter {
+public:
+    explicit StreamWriter(std::ostream& out) noexcept
+        : out_(out) {
+    }
+
+    void Write(const void* data, size_t size) {
+        if (!out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size))) {
+            throw SerializationError("failed to write SimpleVector to stream"s);
+        }
+    }
+
+private:
+    std::ostream& out_;
+};
+
+// Чтение из потока
+class StreamReader {
+public:
+    explicit StreamReader(std::istream& in) noexcept
+        : in_(in) {
+    }
+
+    void Read(void* data, size_t size) {
+        if (!in_.read(static_cast<char*>(data), static_cast<std::streamsize>(size))) {
+            throw SerializationError("unexpected end of SimpleVector stream"s);
+        }
+    }
+
+private:
+    std::istream& in_;
+};
+
+// Запись в конец буфера байтов
+class BufferWriter {
+public:
+    explicit BufferWriter(SimpleVector<char>& buffer) noexcept
+        : buffer_(buffer) {
+    }
+
+    void Write(const void* data, size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        buffer_.Append(bytes, bytes + size);
+    }
+
+private:
+    SimpleVector<char>& buffer_;
+};
+
+// Чтение из буфера байтов, который не копируется
+class BufferReader {
+public:
+    BufferReader(const char* data, size_t size) noexcept
+        : data_(data)
+        , size_(size) {
+    }
+
+    void Read(void* data, size_t size) {
+        std::memcpy(data, Take(size), size);
+    }
+
+    // Возвращает указатель на следующие size байт и пропускает их
+    const char* Take(size_t size) {
+        if (size > size_ - position_) {
+            throw SerializationError("unexpected end of SimpleVector buffer"s);
+        }
+        const char* result = data_ + position_;
+        position_ += size;
+        return result;
+    }
+
+    size_t GetRemaining() const noexcept {
+        return size_ - position_;
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t position_ = 0;
+};
+
+// Строка записывается длиной (8 байт, little-endian) и символами
+template <>
+struct Serializer<std::string> {
+    template <typename Writer>
+    static void Write(Writer& writer, const std::string& item) {
+        const uint64_t size = item.size();
+        unsigned char bytes[8];
+        for (size_t i = 0; i < 8; ++i) {
+            bytes[i] = static_cast<unsigned char>(size >> (8 * i));
+        }
+        writer.Write(bytes, 8);
+        writer.Write(item.data(), item.size());
+    }
+
+    template <typename Reader>
+    static std::string Read(Reader& reader) {
+        unsigned char bytes[8];
+        reader.Read(bytes, 8);
+        uint64_t size = 0;
+        for (size_t i = 0; i < 8; ++i) {
+            size |= uint64_t{bytes[i]} << (8 * i);
+        }
+        std::string item;
+        // Длина не проверена, поэтому строка растёт по мере чтения
+        constexpr uint64_t kBlock = 1 << 16;
+        for (uint64_t read = 0; read < size; read += kBlock) {
+            const size_t block = static_cast<size_t>(std::min(kBlock, size - read));
+            item.resize(item.size() + block);
+            reader.Read(item.data() + item.size() - block, block);
+        }
+        return item;
+    }
+};
+
+// Элементы записываются одним блоком, если тип тривиально копируем и у него нет Serializer
+template <typename Type>
+inline constexpr bool IsSerializedAsBlockV = std::is_trivially_copyable_v<Type> && !HasSerializer<Type>::value;
+
+// Записывает вектор в writer
+template <typename Writer, typename Type, typename Allocator, typename GrowthPolicy>
+void SerializeTo(Writer& writer, const SimpleVector<Type, Allocator, GrowthPolicy>& v) {
+    static_assert(IsSerializedAsBlockV<Type> || HasSerializer<Type>::value,
+                  "Type must be trivially copyable or have a Serializer specialization");
+    SerializationHeader header;
+    header.count = v.GetSize();
+    if constexpr (IsSerializedAsBlockV<Type>) {
+        header.byte_order = SerializationHeader::NativeByteOrder();
+        header.element_size = sizeof(Type);
+        header.Write(writer);
+        writer.Write(v.Data(), v.GetSize() * sizeof(Type));
+    } else {
+        header.Write(writer);
+        for (const Type& item : v) {
+            Serializer<Type>::Write(writer, item);
+        }
+    }
+}
+
+// Читает вектор из reader. Элементы добавляются блоками, поэтому заголовок
+// с неверным количеством не приводит к выделению памяти, которой нет в данных
+template <typename Type, typename Allocator = std::allocator<Type>, typename GrowthPolicy = DoublingGrowth, typename Reader>
+SimpleVector<Type, Allocator, GrowthPolicy> DeserializeFrom(Reader& reader, const Allocator& alloc = Allocator()) {
+    static_assert(IsSerializedAsBlockV<Type> || HasSerializer<Type>::value,
+                  "Type must be trivially copyable or have a Serializer specialization");
+    const SerializationHeader header = SerializationHeader::Read(reader);
+    SimpleVector<Type, Allocator, GrowthPolicy> result(alloc);
+    constexpr uint64_t kBlock = std::max<size_t>((1 << 20) / sizeof(Type), 1);
+    if constexpr (IsSerializedAsBlockV<Type>) {
+        if (header.element_size != sizeof(Type)) {
+            throw SerializationError("element size mismatch: serialized "s + std::to_string(header.element_size) +
+                                     ", expected "s + std::to_string(sizeof(Type)));
+        }
+        if constexpr (std::is_same_v<Reader, BufferReader>) {
+            // Размер буфера известен: если элементов в нём хватает, память выделяется один раз
+            if (header.count <= reader.GetRemaining() / sizeof(Type)) {
+                result.Reserve(static_cast<size_t>(header.count));
+            }
+        }
+        const bool swap_bytes = header.byte_order != SerializationHeader::NativeByteOrder();
+        if (swap_bytes && !std::is_arithmetic_v<Type>) {
+            throw SerializationError("byte order mismatch for non-arithmetic element type"s);
+        }
+        for (uint64_t read = 0; read < header.count; read += kBlock) {
+            const size_t block = static_cast<size_t>(std::min(kBlock, header.count - read));
+            result.AppendConstructed(block, [&reader](Allocator&, Type* dest, size_t count) {
+                reader.Read(dest, count * sizeof(Type));
+            });
+        }
+        if (swap_bytes) {
+            for (Type& item : result) {
+                unsigned char* bytes = reinterpret_cast<unsigned char*>(&item);
+                std::reverse(bytes, bytes + sizeof(Type));
+            }
+        }
+    } else {
+        if (header.element_size != 0) {
+            throw SerializationError("SimpleVector was serialized as a block of trivially copyable elements"s);
+        }
+        for (uint64_t i = 0; i < header.count; ++i) {
+            if (i % kBlock == 0) {
+                result.Reserve(static_cast<size_t>(std::min(header.count, i + kBlock)));
+            }
+            result.PushBack(Serializer<Type>::Read(reader));
+        }
+    }
+    return result;
+}
+
+// Записывает вектор в поток
+template <typename Type, typename Allocator, typename GrowthPolicy>
+void Serialize(std::ostream& out, const SimpleVector<Type, Allocator, GrowthPolicy>& v) {
+    StreamWriter writer(out);
+    SerializeTo(writer, v);
+}
+
+// Дописывает вектор в конец буфера
+template <typename Type, typename Allocator, typename GrowthPolicy>
+void Serialize(SimpleVector<char>& buffer, const SimpleVector<Type, Allocator, GrowthPolicy>& v) {
+    if constexpr (IsSerializedAsBlockV<Type>) {
+        buffer.Reserve(buffer.GetSize() + SerializationHeader::kSize + v.GetSize() * sizeof(Type));
+    }
+    BufferWriter writer(buffer);
+    SerializeTo(writer, v);
+}
+
+// Читает вектор из потока
+template <typename Type, typename Allocator = std::allocator<Type>, typename GrowthPolicy = DoublingGrowth>
+SimpleVector<Type, Allocator, GrowthPolicy> Deserialize(std::istream& in, const Allocator& alloc = Allocator()) {
+    StreamReader reader(in);
+    return DeserializeFrom<Type, Allocator, GrowthPolicy>(reader, alloc);
+}
+
+// Читает вектор из буфера data размером size байт
+template <typename Type, typename Allocator = std::allocator<Type>, typename GrowthPolicy = DoublingGrowth>
+SimpleVector<Type, Allocator, GrowthPolicy> Deserialize(const char* data, size_t size, const Allocator& alloc = Allocator()) {
+    BufferReader reader(data, size);
+    return DeserializeFrom<Type, Allocator, GrowthPolicy>(reader, alloc);
+}
+
+// Возвращает представление элементов, сериализованных в буфере data, без копирования.
+// Элементы должны быть записаны блоком в порядке байтов этой машины, а буфер —
+// выровнен так, чтобы элементы за заголовком были выровнены для Type
+template <typename Type>
+SimpleVectorView<const Type> ViewSerialized(const char* data, size_t size) {
+    static_assert(IsSerializedAsBlockV<Type>, "only block-serialized types can be viewed in place");
+    BufferReader reader(data, size);
+    const SerializationHeader header = SerializationHeader::Read(reader);
+    if (header.element_size != sizeof(Type)) {
+        throw SerializationError("element size mismatch: serialized "s + std::to_string(header.element_size) +
+                                 ", expected "s + std::to_string(sizeof(Type)));
+    }
+    if (header.byte_order != SerializationHeader::NativeByteOrder()) {
+        throw SerializationError("byte order mismatch: elements cannot be viewed in place"s);
+    }
+    if (header.count > reader.GetRemaining() / sizeof(Type)) {
+        throw SerializationError("unexpected end of SimpleVector buffer"s);
+    }
+    const char* payload = reader.Take(static_cast<size_t>(header.count) * sizeof(Type));
+    if (reinterpret_cast<uintptr_t>(payload) % alignof(Type) != 0) {
+        throw SerializationError("SimpleVector payload is misaligned for the element type"s);
+    }
+    return SimpleVectorView<const Type>(reinterpret_cast<const Type*>(payload), static_cast<size_t>(header.count));
+}
@@ -0,0 +1,375 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "hardening.h"
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+using namespace std::literals;
+
+// Общий буфер SharedSimpleVector со счётчиком владельцев. Владелец, который
+// видит счётчик равным единице, может менять элементы: чтобы появился ещё один
+// владелец, нужно скопировать его самого
+template <typename Type, typename Allocator>
+class SharedVectorBlockRef {
+    struct Block {
+        template <typename... Args>
+        explicit Block(Args&&... args)
+            : items(std::forward<Args>(args)...) {
+        }
+
+        std::atomic<size_t> owners{1};
+        SimpleVector<Type, Allocator> items;
+    };
+
+public:
+    using Vector = SimpleVector<Type, Allocator>;
+
+    SharedVectorBlockRef() noexcept = default;
+
+    // Создаёт новый буфер с вектором, построенным из args
+    template <typename... Args>
+    static SharedVectorBlockRef Make(Args&&... args) {
+        return SharedVectorBlockRef(new Block(std::forward<Args>(args)...));
+    }
+
+    SharedVectorBlockRef(const SharedVectorBlockRef& other) noexcept
+        : block_(other.block_) {
+        if (block_ != nullptr) {
+            // Новый владелец появляется от существующего, поэтому упорядочивать нечего
+            block_->owners.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    SharedVectorBlockRef(SharedVectorBlockRef&& other) noexcept
+        : block_(std::exchange(other.block_, nullptr)) {
+    }
+
+    SharedVectorBlockRef& operator=(SharedVectorBlockRef rhs) noexcept {
+        std::swap(block_, rhs.block_);
+        return *this;
+    }
+
+    ~SharedVectorBlockRef() {
+        // acq_rel: изменения и чтения прежних владельцев завершаются до удаления
+        if (block_ != nullptr && block_->owners.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete block_;
+        }
+    }
+
+    explicit operator bool() const noexcept {
+        return block_ != nullptr;
+    }
+
+    // Сообщает, что буфер принадлежит только этой ссылке и его можно менять.
+    // acquire синхронизируется с освобождением буфера другими владельцами
+    bool IsUnique() const noexcept {
+        return block_ != nullptr && block_->owners.load(std::memory_order_acquire) == 1;
+    }
+
+    size_t GetOwnerCount() const noexcept {
+        return block_ == nullptr ? 0 : block_->owners.load(std::memory_order_relaxed);
+    }
+
+    Vector& Get() const noexcept {
+        return block_->items;
+    }
+
+private:
+    Block* block_ = nullptr;
+
+    explicit SharedVectorBlockRef(Block* block) noexcept
+        : block_(block) {
+    }
+};
+
+// Неизменяемый снимок SharedSimpleVector. Держит буфер, пока снимок жив, поэтому
+// его можно читать из другого потока, пока вектор меняется: первое же изменение
+// вектора копирует элементы в новый буфер, а снимок остаётся прежним
+template <typename Type, typename Allocator = std::allocator<Type>>
+class SimpleVectorSnapshot {
+    using BlockRef = SharedVectorBlockRef<Type, Allocator>;
+
+public:
+    using ConstIterator = const Type*;
+
+    SimpleVectorSnapshot() noexcept = default;
+
+    explicit SimpleVectorSnapshot(BlockRef block) noexcept
+        : block_(std::move(block)) {
+    }
+
+    size_t GetSize() const noexcept {
+        return block_ ? block_.Get().GetSize() : 0;
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    const Type* Data() const noexcept {
+        return block_ ? block_.Get().Data() : nullptr;
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        SIMPLE_VECTOR_CHECK(index < GetSize(), "index out of range");
+        return Data()[index];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    const Type& At(size_t index) const {
+        if (index >= GetSize()) {
+            throw std::out_of_range("index out of range"s);
+        }
+        return Data()[index];
+    }
+
+    ConstIterator begin() const noexcept {
+        return Data();
+    }
+
+    ConstIterator end() const noexcept {
+        return Data() + GetSize();
+    }
+
+    SimpleVectorView<const Type> GetView() const noexcept {
+        return SimpleVectorView<const Type>(Data(), GetSize());
+    }
+
+private:
+    BlockRef block_;
+};
+
+// Вектор с копированием при записи. Копия разделяет буфер с исходным вектором и
+// стоит одного атомарного увеличения счётчика, поэтому раздать большой вектор
+// многим читателям можно за O(читателей), а не за O(читателей × размер).
+// Буфер копируется лениво, при первом изменении разделённого вектора: через
+// неконстантные operator[], begin, PushBack, Insert, Erase, Resize и Mutate.
+// Для чтения лучше обращаться к вектору через константную ссылку, чтобы не
+// копировать буфер зря. Ссылки и указатели, полученные через неконстантные
+// методы, нельзя использовать после копирования вектора: запись через них
+// изменит и копию. Snapshot возвращает неизменяемый снимок текущих элементов.
+// Объект SharedSimpleVector, как и SimpleVector, нельзя менять из нескольких
+// потоков одновременно, но разные копии и снимки можно использовать в разных потоках
+template <typename Type, typename Allocator = std::allocator<Type>>
+class SharedSimpleVector {
+    using BlockRef = SharedVectorBlockRef<Type, Allocator>;
+
+public:
+    using Vector = SimpleVector<Type, Allocator>;
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+
+    SharedSimpleVector() noexcept = default;
+
+    // Создаёт вектор из size элементов, инициализированных значением по умолчанию
+    explicit SharedSimpleVector(size_t size)
+        : block_(BlockRef::Make(size)) {
+    }
+
+    // Создаёт вектор из size элементов, инициализированных значением value
+    SharedSimpleVector(size_t size, const Type& value)
+        : block_(BlockRef::Make(size, value)) {
+    }
+
+    SharedSimpleVector(std::initializer_list<Type> init)
+        : block_(BlockRef::Make(init)) {
+    }
+
+    // Забирает элементы вектора items без копирования
+    explicit SharedSimpleVector(Vector&& items)
+        : block_(BlockRef::Make(std::move(items))) {
+    }
+
+    size_t GetSize() const noexcept {
+        return block_ ? block_.Get().GetSize() : 0;
+    }
+
+    size_t GetCapacity() const noexcept {
+        return block_ ? block_.Get().GetCapacity() : 0;
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    // Сообщает, разделяет ли вектор буфер с копиями или снимками
+    bool IsShared() const noexcept {
+        return block_.GetOwnerCount() > 1;
+    }
+
+    // Возвращает элементы для чтения, не копируя буфер
+    const Type* Data() const noexcept {
+        return block_ ? block_.Get().Data() : nullptr;
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        SIMPLE_VECTOR_CHECK(index < GetSize(), "index out of range");
+        return Data()[index];
+    }
+
+    // Возвращает ссылку на элемент, сначала отделив буфер от копий
+    Type& operator[](size_t index) {
+        SIMPLE_VECTOR_CHECK(index < GetSize(), "index out of range");
+        return Mutate().Data()[index];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    const Type& At(size_t index) const {
+        if (index >= GetSize()) {
+            throw std::out_of_range("index out of range"s);
+        }
+        return Data()[index];
+    }
+
+    Type& At(size_t index) {
+        if (index >= GetSize()) {
+            throw std::out_of_range("index out of range"s);
+        }
+        return Mutate().Data()[index];
+    }
+
+    ConstIterator begin() const noexcept {
+        return Data();
+    }
+
+    ConstIterator end() const noexcept {
+        return Data() + GetSize();
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+    Iterator begin() {
+        return Mutate().Data();
+    }
+
+    Iterator end() {
+        Vector& items = Mutate();
+        return items.Data() + items.GetSize();
+    }
+
+    // Возвращает неизменяемый снимок текущих элементов, не копируя их
+    SimpleVectorSnapshot<Type, Allocator> Snapshot() const noexcept {
+        return SimpleVectorSnapshot<Type, Allocator>(block_);
+    }
+
+    // Отделяет буфер от копий и возвращает вектор для произвольных изменений.
+    // Ссылка действительна до следующего копирования или изменения этого объекта
+    Vector& Mutate() {
+        Detach();
+        return block_.Get();
+    }
+
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        // args могут ссылаться на элементы прежнего буфера: он живёт до конца вызова
+        const BlockRef previous = Detach();
+        return block_.Get().EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        return Emplace(pos, value);
+    }
+
+    Iterator Insert(ConstIterator pos, Type&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    Iterator Emplace(ConstIterator pos, Args&&... args) {
+        const size_t index = IndexOf(pos);
+        const BlockRef previous = Detach();
+        Vector& items = block_.Get();
+        items.Emplace(items.cbegin() + index, std::forward<Args>(args)...);
+        return items.Data() + index;
+    }
+
+    Iterator Erase(ConstIterator pos) {
+        const size_t index = IndexOf(pos);
+        SIMPLE_VECTOR_CHECK(index < GetSize(), "erase position out of range");
+        Vector& items = Mutate();
+        items.Erase(items.cbegin() + index);
+        return items.Data() + index;
+    }
+
+    void PopBack() {
+        Mutate().PopBack();
+    }
+
+    void Resize(size_t new_size) {
+        Mutate().Resize(new_size);
+    }
+
+    void Reserve(size_t new_capacity) {
+        Mutate().Reserve(new_capacity);
+    }
+
+    // Удаляет все элементы. Разделённый буфер не копируется, а просто отпускается
+    void Clear() noexcept {
+        if (block_.IsUnique()) {
+            block_.Get().Clear();
+        } else {
+            block_ = BlockRef();
+        }
+    }
+
+    void swap(SharedSimpleVector& other) noexcept {
+        std::swap(block_, other.block_);
+    }
+
+private:
+    BlockRef block_;
+
+    size_t IndexOf(ConstIterator pos) const noexcept {
+        SIMPLE_VECTOR_CHECK(pos >= cbegin() && pos <= cend(), "iterator out of range");
+        return static_cast<size_t>(pos - cbegin());
+    }
+
+    // Делает буфер уникальным: создаёт его для пустого вектора или копирует
+    // элементы разделённого буфера. Возвращает ссылку на прежний буфер, чтобы
+    // аргументы, ссылающиеся на его элементы, оставались действительными
+    BlockRef Detach() {
+        if (block_.IsUnique()) {
+            return BlockRef();
+        }
+        BlockRef copy = block_ ? BlockRef::Make(static_cast<const Vector&>(block_.Get())) : BlockRef::Make();
+        std::swap(block_, copy);
+        return copy;
+    }
+};
+
+template <typename Type, typename Allocator>
+void swap(SharedSimpleVector<Type, Allocator>& lhs, SharedSimpleVector<Type, Allocator>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+template <typename Type, typename Allocator>
+bool operator==(const SharedSimpleVector<Type, Allocator>& lhs, const SharedSimpleVector<Type, Allocator>& rhs) {
+    return SimpleVectorView<const Type>(lhs) == SimpleVectorView<const Type>(rhs);
+}
+
+template <typename Type, typename Allocator>
+bool operator!=(const SharedSimpleVector<Type, Allocator>& lhs, const SharedSimpleVector<Type, Allocator>& rhs) {
+    return !(lhs == rhs);
+}
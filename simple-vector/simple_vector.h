@@ -6,9 +6,20 @@
 #include <stdexcept>
 #include <iostream>
 #include <algorithm>
+#include <array>
+#include <iterator>
+#include <memory>
+#include <type_traits>
 #include <utility>
 
+#include "aligned_allocator.h"
 #include "array_ptr.h"
+#include "constexpr_support.h"
+#include "growth_policy.h"
+#include "hardening.h"
+#include "instrumentation.h"
+#include "relocation.h"
+#include "simple_vector_view.h"
 
 using namespace std::literals;
 
@@ -25,159 +36,514 @@ private:
     size_t capacity_to_reserve_;        
 };
 
-template <typename Type>
-class SimpleVector {
+// Память, занятая буфером вектора: выделенная под вместимость и занятая элементами
+struct VectorMemoryUsage {
+    size_t reserved_bytes = 0;
+    size_t used_bytes = 0;
+};
+
+// Разрешает перегрузку только для итераторов, а не, например, для пары чисел,
+// чтобы Insert(pos, count, value) не путался с Insert(pos, first, last)
+template <typename InputIt>
+using EnableIfInputIterator = std::enable_if_t<
+    std::is_convertible_v<typename std::iterator_traits<InputIt>::iterator_category, std::input_iterator_tag>, int>;
+
+// Для однонаправленных итераторов длину диапазона можно узнать заранее
+template <typename InputIt>
+inline constexpr bool IsForwardIteratorV =
+    std::is_convertible_v<typename std::iterator_traits<InputIt>::iterator_category, std::forward_iterator_tag>;
+
+// Память под элементы выделяется аллокатором Allocator, совместимым с std::allocator
+// (в том числе std::pmr::polymorphic_allocator). Элементы создаются и разрушаются
+// через std::allocator_traits, а передача аллокатора при копировании, перемещении
+// и обмене следует его свойствам propagate_on_container_*.
+// GrowthPolicy (см. growth_policy.h) определяет, насколько вырастает вместимость,
+// когда для нового элемента не хватает места. Если политика определяет
+// OnVectorEvent (см. instrumentation.h), вектор сообщает ей о выделениях памяти,
+// переносах и сдвигах элементов, а SetCallSite помечает, к какому месту в коде их отнести
+template <typename Type, typename Allocator = std::allocator<Type>, typename GrowthPolicy = DoublingGrowth>
+class SimpleVector : public VectorCallSiteHolder<HasVectorEventHook<GrowthPolicy>::value> {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    static constexpr bool kPropagateOnCopy = AllocTraits::propagate_on_container_copy_assignment::value;
+    static constexpr bool kPropagateOnMove = AllocTraits::propagate_on_container_move_assignment::value;
+    static constexpr bool kPropagateOnSwap = AllocTraits::propagate_on_container_swap::value;
+    static constexpr bool kAlwaysEqual = AllocTraits::is_always_equal::value;
+    static constexpr bool kInstrumented = HasVectorEventHook<GrowthPolicy>::value;
+    // Тривиально переносимые элементы можно перенести вместе с блоком,
+    // если аллокатор умеет менять размер блока (см. ReallocAllocator)
+    static constexpr bool kReallocatesBlock = IsTriviallyRelocatableV<Type> && HasReallocate<Allocator>::value;
+
 public:
+    // В режиме SIMPLE_VECTOR_HARDENED итераторы проверяют границы и
+    // обнаруживают использование после перевыделения, вставки и удаления
+#ifdef SIMPLE_VECTOR_HARDENED
+    using Iterator = CheckedIterator<SimpleVector, Type>;
+    using ConstIterator = CheckedIterator<SimpleVector, const Type>;
+#else
     using Iterator = Type*;
     using ConstIterator = const Type*;
+#endif
+    using AllocatorType = Allocator;
+    using GrowthPolicyType = GrowthPolicy;
 
     SimpleVector() noexcept = default;
 
+    SIMPLE_VECTOR_CONSTEXPR explicit SimpleVector(const Allocator& alloc) noexcept
+        : items_(alloc) {
+    }
+
     // Создаёт вектор из size элементов, инициализированных значением по умолчанию
-    explicit SimpleVector(size_t size)         
-        : items_(ArrayPtr<Type>(size))
-        , size_(size)
-        , capacity_(size) {
-        for (auto it = begin(); it != end(); ++it) {
-            *it = Type();
-        }
+    SIMPLE_VECTOR_CONSTEXPR explicit SimpleVector(size_t size, const Allocator& alloc = Allocator())
+        : items_(size, alloc) {
+        UninitializedValueConstructN(Alloc(), items_.Get(), size);
+        size_ = size;
+        NotifyReallocation(0, 0);
     }
 
     // Создаёт вектор из size элементов, инициализированных значением value
-    SimpleVector(size_t size, Type value)
-        : items_(ArrayPtr<Type>(size))
-        , size_(size)
-        , capacity_(size) {
-        std::fill(begin(), end(), value);
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(size_t size, const Type& value, const Allocator& alloc = Allocator())
+        : items_(size, alloc) {
+        UninitializedFillN(Alloc(), items_.Get(), size, value);
+        size_ = size;
+        NotifyReallocation(0, 0);
     }
  
     // Создаёт вектор из std::initializer_list
-    SimpleVector(std::initializer_list<Type> init) {
-        Assign(init, init.size());
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(std::initializer_list<Type> init, const Allocator& alloc = Allocator())
+        : items_(init.size(), alloc) {
+        UninitializedCopyN(Alloc(), init.begin(), init.size(), items_.Get());
+        size_ = init.size();
+        NotifyReallocation(0, 0);
+    }
+
+    // Создаёт вектор из элементов диапазона [first, last)
+    template <typename InputIt, EnableIfInputIterator<InputIt> = 0>
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(InputIt first, InputIt last, const Allocator& alloc = Allocator())
+        : items_(alloc) {
+        Assign(first, last);
     }
     
-    SimpleVector(const ReserveProxyObj& obj) {
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(const ReserveProxyObj& obj, const Allocator& alloc = Allocator())
+        : items_(alloc) {
         Reserve(obj.GetCapacityToReserve());
     }
     
-    SimpleVector(const SimpleVector& other) {
-        Assign(other, other.size_);    
+    // Копия получает аллокатор, который выбирает select_on_container_copy_construction
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(const SimpleVector& other)
+        : SimpleVector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+    }
+
+    // Выделяет память ровно под other.GetSize() элементов и создаёт в ней копии
+    // за один проход (memcpy для тривиально копируемых типов)
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(const SimpleVector& other, const Allocator& alloc)
+        : items_(other.size_, alloc) {
+        UninitializedCopyN(Alloc(), other.Data(), other.size_, items_.Get());
+        size_ = other.size_;
+        NotifyReallocation(0, 0);
+    }
+
+    // Разрушает элементы вектора; память освобождает ArrayPtr
+    SIMPLE_VECTOR_CONSTEXPR ~SimpleVector() {
+        DestroyN(Alloc(), items_.Get(), size_);
     }
     
-    SimpleVector& operator=(const SimpleVector& rhs) {
+    // Если аллокатор остаётся прежним и вместимости хватает, элементы копируются
+    // в уже выделенную память; иначе создаётся копия в новой памяти
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector& operator=(const SimpleVector& rhs) {
         if (!(this == &rhs)) {
-            SimpleVector tmp(rhs);
-            swap(tmp);
+            const bool keeps_allocator = !kPropagateOnCopy || kAlwaysEqual || GetAllocator() == rhs.GetAllocator();
+            if (keeps_allocator && rhs.size_ <= GetCapacity()) {
+                Assign(rhs.Data(), rhs.Data() + rhs.size_);
+            } else {
+                SimpleVector tmp(rhs, kPropagateOnCopy ? rhs.GetAllocator() : GetAllocator());
+                SwapStorage(tmp);
+            }
         }
         return *this;
     }
     
-    SimpleVector(SimpleVector&& other) {
-        items_ = std::move(other.items_);
-        size_ = std::exchange(other.size_, 0);
-        capacity_ = std::exchange(other.capacity_, 0);
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(SimpleVector&& other) noexcept
+        : items_(std::move(other.items_))
+        , size_(std::exchange(other.size_, 0)) {
+        other.Invalidate();
+    }
+
+    // Забирает память other, если аллокаторы равны, иначе перемещает элементы
+    // по одному в память, выделенную alloc
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(SimpleVector&& other, const Allocator& alloc)
+        : items_(alloc) {
+        if (alloc == other.GetAllocator()) {
+            items_ = std::move(other.items_);
+            size_ = std::exchange(other.size_, 0);
+            other.Invalidate();
+        } else {
+            AssignN(std::make_move_iterator(other.Data()), other.size_);
+        }
     }
     
-    SimpleVector& operator=(SimpleVector&&) = default;
+    // Перемещение за O(1), если аллокатор передаётся вместе с памятью или
+    // аллокаторы равны. Иначе элементы перемещаются в память своего аллокатора
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector& operator=(SimpleVector&& rhs) noexcept(kPropagateOnMove || kAlwaysEqual) {
+        if (this != &rhs) {
+            if (kPropagateOnMove || GetAllocator() == rhs.GetAllocator()) {
+                SimpleVector tmp(std::move(rhs));
+                SwapStorage(tmp);
+            } else {
+                SimpleVector tmp(std::move(rhs), GetAllocator());
+                SwapStorage(tmp);
+            }
+        }
+        return *this;
+    }
+
+    // Возвращает копию аллокатора вектора
+    SIMPLE_VECTOR_CONSTEXPR Allocator GetAllocator() const noexcept {
+        return items_.GetAllocator();
+    }
     
-    void Reserve(size_t new_capacity){
-        if (capacity_ < new_capacity) {
+    // Заменяет содержимое вектора элементами диапазона [first, last).
+    // Для однонаправленных итераторов память перевыделяется не больше одного раза
+    // и ровно под размер диапазона; если вместимости хватает, память переиспользуется
+    template <typename InputIt, EnableIfInputIterator<InputIt> = 0>
+    SIMPLE_VECTOR_CONSTEXPR void Assign(InputIt first, InputIt last) {
+        if constexpr (IsForwardIteratorV<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            if (count > GetCapacity()) {
+                AssignN(first, count);
+                return;
+            }
+            const size_t assigned = std::min(count, size_);
+            std::copy_n(first, assigned, Data());
+            std::advance(first, assigned);
+            if (count < size_) {
+                DestroyN(Alloc(), Data() + count, size_ - count);
+            } else {
+                UninitializedCopyN(Alloc(), first, count - size_, Data() + size_);
+            }
+            size_ = count;
+            Invalidate();
+        } else {
+            Clear();
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+    }
+
+    // Добавляет в конец вектора элементы диапазона [first, last)
+    template <typename InputIt, EnableIfInputIterator<InputIt> = 0>
+    SIMPLE_VECTOR_CONSTEXPR void Append(InputIt first, InputIt last) {
+        Insert(cend(), first, last);
+    }
+
+    // Добавляет в конец вектора count элементов, создаваемых в неинициализированной
+    // памяти вызовом construct(alloc, dest, count). При исключении construct должен
+    // сам разрушить созданные им элементы, тогда вектор остаётся прежним.
+    // Так элементы могут создаваться другими потоками (simple_vector_algorithms.h)
+    template <typename ConstructFn>
+    SIMPLE_VECTOR_CONSTEXPR void AppendConstructed(size_t count, ConstructFn construct) {
+        InsertN(cend(), count, construct);
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR void Reserve(size_t new_capacity){
+        if (GetCapacity() < new_capacity) {
             Reallocate(new_capacity);
         }
     }
+
+    // Уменьшает вместимость до размера вектора, освобождая лишнюю память.
+    // У пустого вектора память освобождается полностью
+    SIMPLE_VECTOR_CONSTEXPR void ShrinkToFit() {
+        ShrinkTo(size_);
+    }
+
+    // Уменьшает вместимость до new_capacity, но не меньше размера вектора.
+    // Если вместимость и так не больше, ничего не делает
+    SIMPLE_VECTOR_CONSTEXPR void ShrinkTo(size_t new_capacity) {
+        new_capacity = std::max(new_capacity, size_);
+        if (new_capacity < GetCapacity()) {
+            Reallocate(new_capacity);
+        }
+    }
+
+    // Касается каждой страницы незанятой вместимости, чтобы система отобразила
+    // её сейчас: тогда добавление элементов в запас не прерывается страничными
+    // отказами. Вызывать стоит заранее, после Reserve, вне критичного по задержке пути
+    void PrefaultCapacity() noexcept {
+        if (size_ < GetCapacity()) {
+            PrefaultPages(static_cast<void*>(Data() + size_), (GetCapacity() - size_) * sizeof(Type));
+        }
+    }
+
+    // Переносит элементы в заранее выделенную память storage, которая должна
+    // вмещать их все и быть выделена аллокатором, равным аллокатору вектора.
+    // Так память под рост можно выделить заранее, например в другом потоке
+    SIMPLE_VECTOR_CONSTEXPR void AdoptStorage(ArrayPtr<Type, Allocator>&& storage) {
+        SIMPLE_VECTOR_CHECK(storage.GetSize() >= size_, "adopted storage is too small");
+        SIMPLE_VECTOR_CHECK(storage.GetAllocator() == Alloc(), "adopted storage has an unequal allocator");
+        ArrayPtr<Type, Allocator> new_array(std::move(storage));
+        const size_t old_capacity = GetCapacity();
+        RelocateN(Alloc(), items_.Get(), size_, new_array.Get());
+        items_.swap(new_array);
+        NotifyReallocation(old_capacity, size_);
+        Invalidate();
+    }
+
+    // Возвращает, сколько байт выделено под элементы и сколько из них занято
+    SIMPLE_VECTOR_CONSTEXPR VectorMemoryUsage MemoryUsage() const noexcept {
+        return {GetCapacity() * sizeof(Type), size_ * sizeof(Type)};
+    }
+
+    // Возвращает выравнивание буфера, которое гарантирует аллокатор
+    // (см. AlignedAllocator), или alignof(Type) для остальных аллокаторов
+    static constexpr size_t GetAlignment() noexcept {
+        if constexpr (HasAllocationAlignment<Allocator>::value) {
+            return Allocator::GetAlignment();
+        } else {
+            return alignof(Type);
+        }
+    }
+
+    // Сообщает, выделен ли буфер на больших страницах (см. AlignedAllocator)
+    bool IsHugePageBacked() const noexcept {
+        if constexpr (HasHugePageQuery<Allocator>::value) {
+            return items_ && Allocator::IsHugePageBacked(items_.Get(), GetCapacity());
+        } else {
+            return false;
+        }
+    }
     
-     // Обменивает значение с другим вектором
-    void swap(SimpleVector& other) noexcept {
-         items_.swap(other.items_);
-         std::swap(size_, other.size_);
-         std::swap(capacity_, other.capacity_);
+     // Обменивает значение с другим вектором.
+    // Если аллокатор не передаётся при обмене, аллокаторы векторов должны быть равны
+    SIMPLE_VECTOR_CONSTEXPR void swap(SimpleVector& other) noexcept {
+        SIMPLE_VECTOR_CHECK(kPropagateOnSwap || GetAllocator() == other.GetAllocator(), "swapping vectors with unequal allocators");
+        SwapStorage(other);
     }
     
      // Добавляет элемент в конец вектора
-    // При нехватке места увеличивает вдвое вместимость вектора
-    void PushBack(Type item) {
-        if (capacity_ == 0) {
-            Reallocate(1);
-        }
-        if (size_ == capacity_) {
-            Reallocate(capacity_ * 2);
+    // При нехватке места увеличивает вместимость вектора по политике GrowthPolicy
+    SIMPLE_VECTOR_CONSTEXPR void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    // Создаёт элемент в конце вектора непосредственно из аргументов args.
+    // Возвращает ссылку на созданный элемент
+    template <typename... Args>
+    SIMPLE_VECTOR_CONSTEXPR Type& EmplaceBack(Args&&... args) {
+        if (size_ == GetCapacity()) {
+            GrowAndEmplace(size_, std::forward<Args>(args)...);
+        } else {
+            Construct(Alloc(), Data() + size_, std::forward<Args>(args)...);
+            ++size_;
         }
-        
-        items_[size_] = std::move(item);
-        ++size_;
+        return items_[size_ - 1];
     }
     
     // Вставляет значение value в позицию pos.
     // Возвращает итератор на вставленное значение
-    // Если перед вставкой значения вектор был заполнен полностью,
-    // вместимость вектора должна увеличиться вдвое, а для вектора вместимостью 0 стать равной 1
-    Iterator Insert(ConstIterator pos, Type value) {
-        assert(pos >= cbegin() && pos <= cend());
-        if (size_ < capacity_) {
-            auto it = const_cast<Iterator>(pos);
-            std::move_backward(it, end(), end() + 1);
-            *it = std::move(value);
-            ++size_;
-            return it;
+    // Если перед вставкой значения вектор был заполнен полностью, вместимость
+    // вектора увеличивается по политике GrowthPolicy (по умолчанию вдвое,
+    // а для вектора вместимостью 0 становится равной 1)
+    SIMPLE_VECTOR_CONSTEXPR Iterator Insert(ConstIterator pos, const Type& value) {
+        return Emplace(pos, value);
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR Iterator Insert(ConstIterator pos, Type&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    // Создаёт элемент в позиции pos из аргументов args.
+    // Возвращает итератор на созданный элемент.
+    // При нехватке места элемент создаётся сразу в новой памяти, иначе
+    // (кроме вставки в конец) он создаётся во временном объекте, так как
+    // args могут ссылаться на элементы самого вектора, сдвигаемые при вставке
+    template <typename... Args>
+    SIMPLE_VECTOR_CONSTEXPR Iterator Emplace(ConstIterator pos, Args&&... args) {
+        SIMPLE_VECTOR_CHECK(pos >= cbegin() && pos <= cend(), "insert position out of range");
+        const size_t index = pos - cbegin();
+        if (size_ == GetCapacity()) {
+            GrowAndEmplace(index, std::forward<Args>(args)...);
+            return begin() + index;
+        }
+
+        Type* it = Data() + index;
+        Type* last = Data() + size_;
+        if (it == last) {
+            Construct(Alloc(), it, std::forward<Args>(args)...);
         } else {
-            size_t new_capacity = (size_ == 0 ? 1 : capacity_ * 2); 
-            SimpleVector tmp(new_capacity);
-            auto it = std::move(begin(), const_cast<Iterator>(pos), tmp.begin());
-            *it = std::move(value);
-            std::move(const_cast<Iterator>(pos), end(), it + 1);
-            tmp.size_ = size_ + 1;
-            swap(tmp);
-            return it;
+            Type value(std::forward<Args>(args)...);
+            OpenGap(Alloc(), it, last, 1);
+            try {
+                Construct(Alloc(), it, std::move(value));
+            } catch (...) {
+                CloseGap(Alloc(), it, last + 1, 1);
+                throw;
+            }
+            NotifyShift(size_ - index);
+            Invalidate();
         }
+        ++size_;
+        return begin() + index;
     }
     
-    // "Удаляет" последний элемент вектора. Вектор не должен быть пустым
-    void PopBack() noexcept {
-        assert(!IsEmpty());
+    // Вставляет элементы диапазона [first, last) перед pos. Диапазон не должен
+    // указывать на элементы самого вектора. Возвращает итератор на первый
+    // вставленный элемент (или pos, если диапазон пуст).
+    // Память перевыделяется не больше одного раза, а хвост вектора сдвигается один раз.
+    // Элементы из однопроходного диапазона сначала собираются во временный вектор
+    template <typename InputIt, EnableIfInputIterator<InputIt> = 0>
+    SIMPLE_VECTOR_CONSTEXPR Iterator Insert(ConstIterator pos, InputIt first, InputIt last) {
+        SIMPLE_VECTOR_CHECK(pos >= cbegin() && pos <= cend(), "insert position out of range");
+        if constexpr (IsForwardIteratorV<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            return InsertN(pos, count, [first](Allocator& alloc, Type* dest, size_t n) {
+                UninitializedCopyN(alloc, first, n, dest);
+            });
+        } else {
+            const size_t index = pos - cbegin();
+            SimpleVector buffer(first, last, GetAllocator());
+            Insert(cbegin() + index, std::make_move_iterator(buffer.Data()), std::make_move_iterator(buffer.Data() + buffer.GetSize()));
+            return begin() + index;
+        }
+    }
+
+    // Вставляет count копий value перед pos.
+    // Возвращает итератор на первый вставленный элемент (или pos, если count == 0)
+    SIMPLE_VECTOR_CONSTEXPR Iterator Insert(ConstIterator pos, size_t count, const Type& value) {
+        SIMPLE_VECTOR_CHECK(pos >= cbegin() && pos <= cend(), "insert position out of range");
+        if (count == 0 || size_ + count > GetCapacity()) {
+            // При перевыделении копии создаются до переноса, поэтому value может
+            // ссылаться на элемент вектора
+            return InsertN(pos, count, [&value](Allocator& alloc, Type* dest, size_t n) {
+                UninitializedFillN(alloc, dest, n, value);
+            });
+        }
+        const Type copy(value);
+        return InsertN(pos, count, [&copy](Allocator& alloc, Type* dest, size_t n) {
+            UninitializedFillN(alloc, dest, n, copy);
+        });
+    }
+
+    // Удаляет последний элемент вектора. Вектор не должен быть пустым
+    SIMPLE_VECTOR_CONSTEXPR void PopBack() noexcept {
+        SIMPLE_VECTOR_CHECK(!IsEmpty(), "PopBack on empty vector");
         --size_;
+        AllocTraits::destroy(Alloc(), items_.Get() + size_);
+        Invalidate();
+        MaybeShrink();
     }
     
     // Удаляет элемент вектора в указанной позиции
-    Iterator Erase(ConstIterator pos) {
-        assert(pos >= cbegin() && pos < cend());
-        auto it = const_cast<Iterator>(pos);
-        std::move(it + 1, end(), it);
+    SIMPLE_VECTOR_CONSTEXPR Iterator Erase(ConstIterator pos) {
+        SIMPLE_VECTOR_CHECK(pos >= cbegin() && pos < cend(), "erase position out of range");
+        const size_t index = pos - cbegin();
+        EraseN(Alloc(), Data() + index, Data() + size_, 1);
         --size_;
-        return it;
+        NotifyShift(size_ - index);
+        Invalidate();
+        MaybeShrink();
+        return begin() + index;
+    }
+
+    // Удаляет элементы диапазона [first, last), сдвигая хвост вектора один раз.
+    // Возвращает итератор на элемент, следовавший за удалёнными
+    SIMPLE_VECTOR_CONSTEXPR Iterator Erase(ConstIterator first, ConstIterator last) {
+        SIMPLE_VECTOR_CHECK(first >= cbegin() && first <= last && last <= cend(), "erase range out of range");
+        const size_t index = first - cbegin();
+        const size_t count = last - first;
+        if (count == 0) {
+            // Ничего не сдвигается: событие сдвига не возникает, итераторы действительны
+            return begin() + index;
+        }
+        EraseN(Alloc(), Data() + index, Data() + size_, count);
+        size_ -= count;
+        NotifyShift(size_ - index);
+        Invalidate();
+        MaybeShrink();
+        return begin() + index;
     }
     
-    
-    
+    // Удаляет элемент в позиции pos за O(1), перемещая на его место последний
+    // элемент. Порядок элементов не сохраняется. Возвращает итератор на элемент,
+    // занявший место удалённого, или end(), если удалён последний
+    SIMPLE_VECTOR_CONSTEXPR Iterator SwapRemove(ConstIterator pos) {
+        SIMPLE_VECTOR_CHECK(pos >= cbegin() && pos < cend(), "erase position out of range");
+        const size_t index = pos - cbegin();
+        Type* const last = Data() + size_ - 1;
+        if (Data() + index != last) {
+            Data()[index] = std::move(*last);
+        }
+        AllocTraits::destroy(Alloc(), last);
+        --size_;
+        Invalidate();
+        MaybeShrink();
+        return begin() + index;
+    }
+
+    // Удаляет элементы, для которых pred истинен, за один проход, сохраняя порядок
+    // остальных. Возвращает количество удалённых элементов
+    template <typename Predicate>
+    SIMPLE_VECTOR_CONSTEXPR size_t EraseIf(Predicate pred) {
+        Type* const new_last = CompactIf(Alloc(), Data(), Data() + size_, pred);
+        const size_t removed = static_cast<size_t>(Data() + size_ - new_last);
+        if (removed != 0) {
+            size_ -= removed;
+            Invalidate();
+            MaybeShrink();
+        }
+        return removed;
+    }
+
+    // Удаляет элементы с индексами indices, которые должны строго возрастать.
+    // Каждый оставшийся элемент передвигается не больше одного раза
+    SIMPLE_VECTOR_CONSTEXPR void EraseIndices(SimpleVectorView<const size_t> indices) {
+        for (size_t k = 0; k < indices.GetSize(); ++k) {
+            SIMPLE_VECTOR_CHECK(indices[k] < size_ && (k == 0 || indices[k - 1] < indices[k]),
+                                "erase indices must be increasing and in range");
+        }
+        if (indices.IsEmpty()) {
+            return;
+        }
+        size_ = static_cast<size_t>(CompactIndices(Alloc(), Data(), size_, indices.Data(), indices.GetSize()) - Data());
+        Invalidate();
+        MaybeShrink();
+    }
+
     // Возвращает количество элементов в массиве
-    size_t GetSize() const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR size_t GetSize() const noexcept {
         return size_;
     }
 
     // Возвращает вместимость массива
-    size_t GetCapacity() const noexcept {
-        return capacity_;
+    SIMPLE_VECTOR_CONSTEXPR size_t GetCapacity() const noexcept {
+        return items_.GetSize();
     }
 
     // Сообщает, пустой ли массив
-    bool IsEmpty() const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR bool IsEmpty() const noexcept {
         return size_ == 0;
     }
 
     // Возвращает ссылку на элемент с индексом index
-    Type& operator[](size_t index) noexcept {
-        assert(index < size_);
+    SIMPLE_VECTOR_CONSTEXPR Type& operator[](size_t index) noexcept {
+        SIMPLE_VECTOR_CHECK(index < size_, "index out of range");
         return items_[index];
     }
 
     // Возвращает константную ссылку на элемент с индексом index
-    const Type& operator[](size_t index) const noexcept {
-        assert(index < size);
+    SIMPLE_VECTOR_CONSTEXPR const Type& operator[](size_t index) const noexcept {
+        SIMPLE_VECTOR_CHECK(index < size_, "index out of range");
         return items_[index];
     }
 
     // Возвращает константную ссылку на элемент с индексом index
     // Выбрасывает исключение std::out_of_range, если index >= size
-    Type& At(size_t index) {
+    SIMPLE_VECTOR_CONSTEXPR Type& At(size_t index) {
         if (index >= size_) {
             throw std::out_of_range("index out of range"s);
         }
@@ -186,126 +552,360 @@ public:
 
     // Возвращает константную ссылку на элемент с индексом index
     // Выбрасывает исключение std::out_of_range, если index >= size
-    const Type& At(size_t index) const {
+    SIMPLE_VECTOR_CONSTEXPR const Type& At(size_t index) const {
         if (index >= size_) {
             throw std::out_of_range("index out of range"s);
         }
         return items_[index];
     }
 
-    // Обнуляет размер массива, не изменяя его вместимость
-    void Clear() noexcept {
+    // Разрушает элементы массива, не изменяя его вместимость
+    // (если политика роста не освобождает память при удалении элементов)
+    SIMPLE_VECTOR_CONSTEXPR void Clear() noexcept {
+        DestroyN(Alloc(), items_.Get(), size_);
         size_ = 0;
+        Invalidate();
+        MaybeShrink();
     }
 
     // Изменяет размер массива.
-    // При увеличении размера новые элементы получают значение по умолчанию для типа Type
-    void Resize(size_t new_size) {
-        if (new_size > capacity_) {
-            auto new_capacity = std::max(new_size, capacity_ * 2);
-            Reallocate(new_capacity);
+    // При увеличении размера новые элементы получают значение по умолчанию для типа Type,
+    // при уменьшении лишние элементы разрушаются
+    SIMPLE_VECTOR_CONSTEXPR void Resize(size_t new_size) {
+        if (new_size <= size_) {
+            DestroyN(Alloc(), Data() + new_size, size_ - new_size);
+            size_ = new_size;
+            Invalidate();
+            MaybeShrink();
+            return;
         }
-        
-        if (new_size > size_) {
-            for (auto it = end(); it != end() + new_size - size_; ++it){
-                *it = Type();
-            }
+
+        if (new_size > GetCapacity()) {
+            Reallocate(NextCapacity(new_size));
         }
         
+        UninitializedValueConstructN(Alloc(), Data() + size_, new_size - size_);
         size_ = new_size;
     }
 
-    // Возвращает итератор на начало массива
+    // Возвращает указатель на первый элемент массива
     // Для пустого массива может быть равен (или не равен) nullptr
-    Iterator begin() noexcept {
+    SIMPLE_VECTOR_CONSTEXPR Type* Data() noexcept {
         return items_.Get();
     }
 
+    SIMPLE_VECTOR_CONSTEXPR const Type* Data() const noexcept {
+        return items_.Get();
+    }
+
+    // Возвращает итератор на начало массива
+    // Для пустого массива может быть равен (или не равен) nullptr
+    SIMPLE_VECTOR_CONSTEXPR Iterator begin() noexcept {
+        return MakeIterator(Data());
+    }
+
     // Возвращает итератор на элемент, следующий за последним
     // Для пустого массива может быть равен (или не равен) nullptr
-    Iterator end() noexcept {
-        return begin() + size_;
+    SIMPLE_VECTOR_CONSTEXPR Iterator end() noexcept {
+        return MakeIterator(Data() + size_);
     }
 
     // Возвращает константный итератор на начало массива
     // Для пустого массива может быть равен (или не равен) nullptr
-    ConstIterator begin() const noexcept {
-        return items_.Get();
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator begin() const noexcept {
+        return MakeIterator(Data());
     }
 
     // Возвращает итератор на элемент, следующий за последним
     // Для пустого массива может быть равен (или не равен) nullptr
-    ConstIterator end() const noexcept {
-        return begin() + size_;
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator end() const noexcept {
+        return MakeIterator(Data() + size_);
     }
 
     // Возвращает константный итератор на начало массива
     // Для пустого массива может быть равен (или не равен) nullptr
-    ConstIterator cbegin() const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator cbegin() const noexcept {
         return begin();
     }
 
     // Возвращает итератор на элемент, следующий за последним
     // Для пустого массива может быть равен (или не равен) nullptr
-    ConstIterator cend() const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator cend() const noexcept {
         return end();
     }
+
+#ifdef SIMPLE_VECTOR_HARDENED
+    // Поколение вектора: растёт, когда итераторы становятся недействительными
+    SIMPLE_VECTOR_CONSTEXPR uint64_t GetGeneration() const noexcept {
+        return generation_;
+    }
+#endif
 private:
-    ArrayPtr<Type> items_;
+    // Память под GetCapacity() элементов; объекты созданы только в [0, size_)
+    ArrayPtr<Type, Allocator> items_;
     size_t size_ = 0;
-    size_t capacity_ = 0;
+#ifdef SIMPLE_VECTOR_HARDENED
+    uint64_t generation_ = 0;
+#endif
+
+    SIMPLE_VECTOR_CONSTEXPR Allocator& Alloc() noexcept {
+        return items_.GetAllocator();
+    }
+
+#ifdef SIMPLE_VECTOR_HARDENED
+    SIMPLE_VECTOR_CONSTEXPR Iterator MakeIterator(Type* ptr) noexcept {
+        return Iterator(this, ptr);
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator MakeIterator(const Type* ptr) const noexcept {
+        return ConstIterator(this, ptr);
+    }
+#else
+    static SIMPLE_VECTOR_CONSTEXPR Iterator MakeIterator(Type* ptr) noexcept {
+        return ptr;
+    }
+
+    static SIMPLE_VECTOR_CONSTEXPR ConstIterator MakeIterator(const Type* ptr) noexcept {
+        return ptr;
+    }
+#endif
+
+    // Делает недействительными итераторы вектора в режиме SIMPLE_VECTOR_HARDENED
+    SIMPLE_VECTOR_CONSTEXPR void Invalidate() noexcept {
+#ifdef SIMPLE_VECTOR_HARDENED
+        ++generation_;
+#endif
+    }
+
+    // Обменивает память, размер и, если это возможно, аллокаторы
+    SIMPLE_VECTOR_CONSTEXPR void SwapStorage(SimpleVector& other) noexcept {
+        items_.swap(other.items_);
+        std::swap(size_, other.size_);
+        Invalidate();
+        other.Invalidate();
+    }
     
-    template <typename Values>
-    void Assign(const Values& values, size_t size) {
-        SimpleVector tmp(size);
-        std::move(values.begin(), values.end(), tmp.begin());
-        swap(tmp);
+    // Заменяет содержимое count элементами из first, создавая их
+    // в новой памяти ровно под count элементов
+    template <typename InputIt>
+    SIMPLE_VECTOR_CONSTEXPR void AssignN(InputIt first, size_t count) {
+        ArrayPtr<Type, Allocator> new_items(count, Alloc());
+        UninitializedCopyN(new_items.GetAllocator(), first, count, new_items.Get());
+        const size_t old_capacity = GetCapacity();
+        Clear();
+        items_ = std::move(new_items);
+        size_ = count;
+        Invalidate();
+        NotifyReallocation(old_capacity, 0);
     }
     
-    void Reallocate(size_t new_capacity) { 
-        ArrayPtr<Type> new_array(new_capacity); 
-        std::move(items_.Get(), items_.Get() + size_, new_array.Get());
+    // Возвращает вместимость, до которой нужно вырасти, чтобы вместить required
+    // элементов, по политике GrowthPolicy, но не больше max_size аллокатора.
+    // Выбрасывает исключение std::length_error, если required больше max_size
+    SIMPLE_VECTOR_CONSTEXPR size_t NextCapacity(size_t required) const {
+        const size_t max_size = AllocTraits::max_size(items_.GetAllocator());
+        if (required > max_size) {
+            throw std::length_error("SimpleVector is too long"s);
+        }
+        return std::min(GrowthPolicy::NextCapacity(GetCapacity(), required, sizeof(Type)), max_size);
+    }
+
+    // Уменьшает вместимость после удаления элементов, если этого требует политика
+    // роста. Освобождение памяти — лишь оптимизация, поэтому ошибка перевыделения
+    // игнорируется: прерванный перенос оставляет вектор прежним
+    SIMPLE_VECTOR_CONSTEXPR void MaybeShrink() noexcept {
+        if constexpr (HasShrinkCapacity<GrowthPolicy>::value) {
+            const size_t new_capacity = GrowthPolicy::ShrinkCapacity(size_, GetCapacity(), sizeof(Type));
+            if (new_capacity < GetCapacity()) {
+                try {
+                    Reallocate(std::max(new_capacity, size_));
+                } catch (...) {
+                }
+            }
+        }
+    }
+
+    // Выделяет память вместимостью по политике роста, создаёт в ней
+    // элемент с индексом index из args и переносит остальные
+    // элементы вокруг него. Новый элемент создаётся до переноса, поэтому
+    // args могут ссылаться на элементы самого вектора
+    template <typename... Args>
+    SIMPLE_VECTOR_CONSTEXPR void GrowAndEmplace(size_t index, Args&&... args) {
+        if constexpr (kReallocatesBlock) {
+            if (index == size_ && items_ && !IsConstantEvaluated()) {
+                // Перевыделенный блок может переехать, а args — ссылаться на элементы
+                // вектора, поэтому новый элемент сначала создаётся во временном объекте
+                Type value(std::forward<Args>(args)...);
+                Reallocate(NextCapacity(size_ + 1));
+                Construct(Alloc(), Data() + size_, std::move(value));
+                ++size_;
+                return;
+            }
+        }
+        GrowAndConstruct(index, 1, [&args...](Allocator& alloc, Type* dest, size_t) {
+            Construct(alloc, dest, std::forward<Args>(args)...);
+        });
+    }
+
+    // Выделяет память вместимостью по политике роста, создаёт в ней count
+    // элементов с индекса index вызовом construct(alloc, dest, count) и переносит
+    // остальные элементы вокруг них.
+    // Исходные элементы разрушаются, только когда перенесены все, поэтому при
+    // исключении вектор остаётся прежним
+    template <typename ConstructFn>
+    SIMPLE_VECTOR_CONSTEXPR void GrowAndConstruct(size_t index, size_t count, ConstructFn construct) {
+        ArrayPtr<Type, Allocator> new_items(NextCapacity(size_ + count), Alloc());
+        Type* new_begin = new_items.Get();
+        construct(Alloc(), new_begin + index, count);
+        try {
+            UninitializedRelocateN(Alloc(), Data(), index, new_begin);
+        } catch (...) {
+            DestroyN(Alloc(), new_begin + index, count);
+            throw;
+        }
+        try {
+            UninitializedRelocateN(Alloc(), Data() + index, size_ - index, new_begin + index + count);
+        } catch (...) {
+            DestroyN(Alloc(), new_begin, index + count);
+            throw;
+        }
+        DestroyRelocatedN(Alloc(), items_.Get(), size_);
+        items_.swap(new_items);
+        NotifyReallocation(new_items.GetSize(), size_);
+        size_ += count;
+        Invalidate();
+    }
+
+    // Вставляет count элементов перед pos, создавая их вызовом construct(alloc, dest, count),
+    // который при исключении должен сам разрушить созданные им элементы.
+    // Если места не хватает, память перевыделяется один раз, иначе хвост
+    // сдвигается на count позиций
+    template <typename ConstructFn>
+    SIMPLE_VECTOR_CONSTEXPR Iterator InsertN(ConstIterator pos, size_t count, ConstructFn construct) {
+        const size_t index = pos - cbegin();
+        if (count == 0) {
+            return begin() + index;
+        }
+        if (size_ + count > GetCapacity()) {
+            GrowAndConstruct(index, count, construct);
+            return begin() + index;
+        }
+        Type* it = Data() + index;
+        OpenGap(Alloc(), it, Data() + size_, count);
+        try {
+            construct(Alloc(), it, count);
+        } catch (...) {
+            CloseGap(Alloc(), it, Data() + size_ + count, count);
+            throw;
+        }
+        NotifyShift(size_ - index);
+        if (index < size_) {
+            Invalidate();
+        }
+        size_ += count;
+        return begin() + index;
+    }
+
+    // Переносит элементы в новую память вместимостью new_capacity.
+    // Незанятая часть новой памяти остаётся неинициализированной
+    SIMPLE_VECTOR_CONSTEXPR void Reallocate(size_t new_capacity) {
+        if (TryReallocateBlock(new_capacity)) {
+            return;
+        }
+        ArrayPtr<Type, Allocator> new_array(new_capacity, Alloc()); 
+        RelocateN(Alloc(), items_.Get(), size_, new_array.Get());
         items_.swap(new_array);
-        capacity_ = new_capacity;
+        NotifyReallocation(new_array.GetSize(), size_);
+        Invalidate();
+    }
+
+    // Меняет вместимость методом reallocate аллокатора (realloc, mremap), если
+    // элементы тривиально переносимы: вектор не копирует их сам, а большие блоки
+    // ядро просто переотображает. Возвращает false, если блок остался прежним
+    SIMPLE_VECTOR_CONSTEXPR bool TryReallocateBlock(size_t new_capacity) noexcept {
+        if constexpr (kReallocatesBlock) {
+            if (!IsConstantEvaluated()) {
+                const size_t old_capacity = GetCapacity();
+                if (items_.TryReallocate(new_capacity)) {
+                    // Элементы перенёс аллокатор, а не вектор
+                    NotifyReallocation(old_capacity, 0);
+                    Invalidate();
+                    return true;
+                }
+            }
+        } else {
+            static_cast<void>(new_capacity);
+        }
+        return false;
     }
-};
 
-template <typename Type>
-inline bool operator==(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
-    if (&lhs == &rhs) {
-        return true;
+    // Сообщает политике роста, что вместимость изменилась с old_capacity
+    // на текущую, а в новую память перенесено moved элементов
+    SIMPLE_VECTOR_CONSTEXPR void NotifyReallocation(size_t old_capacity, size_t moved) const noexcept {
+        if constexpr (kInstrumented) {
+            if (IsConstantEvaluated() || old_capacity == GetCapacity()) {
+                return;
+            }
+            const VectorEventKind kind = old_capacity == 0 ? VectorEventKind::kAllocate : VectorEventKind::kReallocate;
+            GrowthPolicy::OnVectorEvent({kind, this->GetCallSite(), this, sizeof(Type), old_capacity, GetCapacity(), moved});
+        }
     }
-    if (lhs.GetSize() == rhs.GetSize()) {
-	    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+
+    // Сообщает политике роста, что при вставке или удалении сдвинуто shifted элементов
+    SIMPLE_VECTOR_CONSTEXPR void NotifyShift(size_t shifted) const noexcept {
+        if constexpr (kInstrumented) {
+            if (!IsConstantEvaluated() && shifted > 0) {
+                GrowthPolicy::OnVectorEvent({VectorEventKind::kShift, this->GetCallSite(), this, sizeof(Type),
+                                             GetCapacity(), GetCapacity(), shifted});
+            }
+        }
     }
-    return false;
+};
+
+template <typename Type, typename Allocator, typename GrowthPolicy>
+SIMPLE_VECTOR_CONSTEXPR bool operator==(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
+    return SimpleVectorView<const Type>(lhs) == SimpleVectorView<const Type>(rhs);
 }
 
-template <typename Type>
-inline bool operator!=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Allocator, typename GrowthPolicy>
+SIMPLE_VECTOR_CONSTEXPR bool operator!=(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
     return !(lhs == rhs);
 }
 
-template <typename Type>
-inline bool operator<(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
-    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+template <typename Type, typename Allocator, typename GrowthPolicy>
+SIMPLE_VECTOR_CONSTEXPR bool operator<(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
+    return SimpleVectorView<const Type>(lhs) < SimpleVectorView<const Type>(rhs);
 }
 
-template <typename Type>
-inline bool operator<=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Allocator, typename GrowthPolicy>
+SIMPLE_VECTOR_CONSTEXPR bool operator<=(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
     return !(rhs < lhs);
 }
 
-template <typename Type>
-inline bool operator>(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Allocator, typename GrowthPolicy>
+SIMPLE_VECTOR_CONSTEXPR bool operator>(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
     return rhs < lhs;
 }
 
-template <typename Type>
-inline bool operator>=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Allocator, typename GrowthPolicy>
+SIMPLE_VECTOR_CONSTEXPR bool operator>=(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
     return rhs <= lhs;
 } 
 
+// Копирует элементы вектора из N элементов в std::array. В C++20 вектор можно
+// заполнить во время компиляции и сохранить результат в constexpr-таблицу:
+//     constexpr auto kTable = ToArray<256>(MakeTable());
+// Выбрасывает исключение std::length_error, если в векторе не N элементов
+template <size_t N, typename Type, typename Allocator, typename GrowthPolicy>
+SIMPLE_VECTOR_CONSTEXPR std::array<Type, N> ToArray(const SimpleVector<Type, Allocator, GrowthPolicy>& v) {
+    if (v.GetSize() != N) {
+        throw std::length_error("SimpleVector size does not match array size"s);
+    }
+    std::array<Type, N> result{};
+    std::copy_n(v.Data(), N, result.begin());
+    return result;
+}
+
 ReserveProxyObj Reserve(size_t capacity_to_reserve) {
     return ReserveProxyObj(capacity_to_reserve);
 }
\ No newline at end of file
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "growth_policy.h"
+#include "simple_vector.h"
+#include "thread_pool.h"
+#include "uninitialized.h"
+
+// Параллельные алгоритмы над SimpleVector: ParallelFill, ParallelTransform,
+// ParallelReduce и ParallelSort. Первым аргументом передаётся пул потоков
+// (ThreadPool) либо политика выполнения kSequencedPolicy или kParallelPolicy
+// (общий пул DefaultThreadPool).
+// Массив делится на части, границы которых приходятся на начало страниц памяти,
+// поэтому разные потоки не пишут в одну страницу и одну строку кэша.
+// Алгоритмы, создающие элементы, создают их в тех потоках, которые обрабатывают
+// соответствующую часть: при первом обращении ОС размещает страницу на узле NUMA
+// этого потока
+
+// Выполнение в вызывающем потоке
+struct SequencedPolicy {
+};
+
+// Выполнение в общем пуле потоков DefaultThreadPool
+struct ParallelPolicy {
+};
+
+inline constexpr SequencedPolicy kSequencedPolicy{};
+inline constexpr ParallelPolicy kParallelPolicy{};
+
+// Границы частей выравниваются по страницам такого размера
+inline constexpr size_t kParallelPageSize = 4096;
+
+// Меньшие части не выгодно отдавать другому потоку
+inline constexpr size_t kMinParallelChunkBytes = 16 * kParallelPageSize;
+
+inline ThreadPool& GetThreadPool(ThreadPool& pool) noexcept {
+    return pool;
+}
+
+inline ThreadPool& GetThreadPool(SequencedPolicy) {
+    static ThreadPool pool(0);
+    return pool;
+}
+
+inline ThreadPool& GetThreadPool(ParallelPolicy) {
+    return DefaultThreadPool();
+}
+
+// Разбиение count элементов размера element_size, начинающихся по адресу data,
+// не больше чем на max_chunks частей по целым страницам.
+// Части, кроме первой, начинаются с первого элемента, начинающегося на своей странице
+class ChunkPartition {
+public:
+    ChunkPartition(const void* data, size_t count, size_t element_size, size_t max_chunks) {
+        const size_t bytes = count * element_size;
+        const size_t chunk_count = std::max<size_t>(
+            std::min(max_chunks, bytes / kMinParallelChunkBytes), 1);
+        const size_t chunk_bytes = RoundUpCapacity((bytes + chunk_count - 1) / chunk_count, kParallelPageSize);
+        const uintptr_t address = reinterpret_cast<uintptr_t>(data);
+
+        boundaries_.reserve(chunk_count + 1);
+        boundaries_.push_back(0);
+        for (size_t i = 1; i < chunk_count; ++i) {
+            const size_t offset = RoundUpCapacity(address + i * chunk_bytes, kParallelPageSize) - address;
+            const size_t boundary = std::min(count, (offset + element_size - 1) / element_size);
+            boundaries_.push_back(std::max(boundary, boundaries_.back()));
+        }
+        boundaries_.push_back(count);
+    }
+
+    size_t GetChunkCount() const noexcept {
+        return boundaries_.size() - 1;
+    }
+
+    size_t GetBegin(size_t chunk) const noexcept {
+        return boundaries_[chunk];
+    }
+
+    size_t GetEnd(size_t chunk) const noexcept {
+        return boundaries_[chunk + 1];
+    }
+
+private:
+    std::vector<size_t> boundaries_;
+};
+
+// Вызывает process(begin, end) для каждой части массива [data, data + count) в потоках пула
+template <typename Type, typename ProcessChunk>
+void ForEachChunk(ThreadPool& pool, const Type* data, size_t count, ProcessChunk process) {
+    const ChunkPartition partition(data, count, sizeof(Type), pool.GetThreadCount());
+    pool.Run(partition.GetChunkCount(), [&](size_t chunk) {
+        process(partition.GetBegin(chunk), partition.GetEnd(chunk));
+    });
+}
+
+// Создаёт count элементов в неинициализированной памяти dest: каждую часть создаёт
+// поток пула вызовом construct(alloc, dest + begin, begin, end), который при исключении
+// сам разрушает созданные им элементы. Если часть не удалось создать,
+// остальные созданные части разрушаются
+template <typename Allocator, typename Type, typename ConstructChunk>
+void ParallelUninitializedConstruct(ThreadPool& pool, Allocator& alloc, Type* dest, size_t count,
+                                    ConstructChunk construct) {
+    const ChunkPartition partition(dest, count, sizeof(Type), pool.GetThreadCount());
+    const size_t chunk_count = partition.GetChunkCount();
+    std::unique_ptr<bool[]> constructed(new bool[chunk_count]());
+    try {
+        pool.Run(chunk_count, [&](size_t chunk) {
+            const size_t begin = partition.GetBegin(chunk);
+            construct(alloc, dest + begin, begin, partition.GetEnd(chunk));
+            constructed[chunk] = true;
+        });
+    } catch (...) {
+        for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+            if (constructed[chunk]) {
+                const size_t begin = partition.GetBegin(chunk);
+                DestroyN(alloc, dest + begin, partition.GetEnd(chunk) - begin);
+            }
+        }
+        throw;
+    }
+}
+
+// Присваивает значение value всем элементам вектора
+template <typename Executor, typename Type, typename Allocator, typename GrowthPolicy>
+void ParallelFill(Executor&& executor, SimpleVector<Type, Allocator, GrowthPolicy>& v, const Type& value) {
+    Type* data = v.Data();
+    ForEachChunk(GetThreadPool(executor), data, v.GetSize(), [data, &value](size_t begin, size_t end) {
+        std::fill(data + begin, data + end, value);
+    });
+}
+
+// Заменяет содержимое вектора count копиями value. value может быть элементом v.
+// Если вместимости не хватает, копии создаются в новой памяти потоками пула
+template <typename Executor, typename Type, typename Allocator, typename GrowthPolicy>
+void ParallelFill(Executor&& executor, SimpleVector<Type, Allocator, GrowthPolicy>& v, size_t count,
+                  const Type& value) {
+    const std::less<const Type*> before;
+    const Type* const data = v.Data();
+    if (!before(std::addressof(value), data) && before(std::addressof(value), data + v.GetSize())) {
+        // Clear разрушит value, поэтому копии создаются из временного объекта
+        const Type copy(value);
+        ParallelFill(std::forward<Executor>(executor), v, count, copy);
+        return;
+    }
+    v.Clear();
+    v.Reserve(count);
+    ThreadPool& pool = GetThreadPool(executor);
+    v.AppendConstructed(count, [&pool, &value](Allocator& alloc, Type* dest, size_t n) {
+        ParallelUninitializedConstruct(pool, alloc, dest, n, [&value](Allocator& a, Type* chunk, size_t begin, size_t end) {
+            UninitializedFillN(a, chunk, end - begin, value);
+        });
+    });
+}
+
+// Заменяет каждый элемент вектора результатом op(элемент)
+template <typename Executor, typename Type, typename Allocator, typename GrowthPolicy, typename UnaryOp>
+void ParallelTransform(Executor&& executor, SimpleVector<Type, Allocator, GrowthPolicy>& v, UnaryOp op) {
+    Type* data = v.Data();
+    ForEachChunk(GetThreadPool(executor), data, v.GetSize(), [data, &op](size_t begin, size_t end) {
+        std::transform(data + begin, data + end, data + begin, op);
+    });
+}
+
+// Заменяет содержимое вектора out результатами op для элементов вектора in.
+// Новые элементы создаются потоками пула в памяти, выделенной ровно под них
+template <typename Executor, typename InType, typename InAllocator, typename InGrowthPolicy,
+          typename OutType, typename OutAllocator, typename OutGrowthPolicy, typename UnaryOp>
+void ParallelTransform(Executor&& executor, const SimpleVector<InType, InAllocator, InGrowthPolicy>& in,
+                       SimpleVector<OutType, OutAllocator, OutGrowthPolicy>& out, UnaryOp op) {
+    assert(static_cast<const void*>(&in) != static_cast<const void*>(&out));
+    out.Clear();
+    out.Reserve(in.GetSize());
+    ThreadPool& pool = GetThreadPool(executor);
+    const InType* source = in.Data();
+    out.AppendConstructed(in.GetSize(), [&pool, source, &op](OutAllocator& alloc, OutType* dest, size_t n) {
+        ParallelUninitializedConstruct(pool, alloc, dest, n,
+                                       [source, &op](OutAllocator& a, OutType* chunk, size_t begin, size_t end) {
+            UninitializedConstructN(a, chunk, end - begin, [item = source + begin, &op](OutAllocator& ptr_alloc, OutType* ptr) mutable {
+                Construct(ptr_alloc, ptr, op(*item++));
+            });
+        });
+    });
+}
+
+// Сворачивает элементы вектора операцией op, начиная со значения init.
+// Части сворачиваются параллельно, а результаты частей — по порядку,
+// поэтому op должна быть ассоциативной, но не обязательно коммутативной
+template <typename Executor, typename Type, typename Allocator, typename GrowthPolicy, typename Value,
+          typename BinaryOp = std::plus<>>
+Value ParallelReduce(Executor&& executor, const SimpleVector<Type, Allocator, GrowthPolicy>& v, Value init,
+                     BinaryOp op = BinaryOp()) {
+    ThreadPool& pool = GetThreadPool(executor);
+    const Type* data = v.Data();
+    const ChunkPartition partition(data, v.GetSize(), sizeof(Type), pool.GetThreadCount());
+    std::vector<std::optional<Value>> partial(partition.GetChunkCount());
+    pool.Run(partition.GetChunkCount(), [&](size_t chunk) {
+        const size_t begin = partition.GetBegin(chunk);
+        const size_t end = partition.GetEnd(chunk);
+        if (begin != end) {
+            partial[chunk] = std::accumulate(data + begin + 1, data + end, Value(data[begin]), op);
+        }
+    });
+    for (std::optional<Value>& value : partial) {
+        if (value) {
+            init = op(std::move(init), std::move(*value));
+        }
+    }
+    return init;
+}
+
+// Сортирует элементы вектора по comp: части сортируются параллельно,
+// затем соседние отсортированные части попарно сливаются, тоже параллельно.
+// Сортировка не стабильна
+template <typename Executor, typename Type, typename Allocator, typename GrowthPolicy, typename Compare = std::less<>>
+void ParallelSort(Executor&& executor, SimpleVector<Type, Allocator, GrowthPolicy>& v, Compare comp = Compare()) {
+    ThreadPool& pool = GetThreadPool(executor);
+    Type* data = v.Data();
+    const ChunkPartition partition(data, v.GetSize(), sizeof(Type), pool.GetThreadCount());
+    const size_t chunk_count = partition.GetChunkCount();
+    pool.Run(chunk_count, [&](size_t chunk) {
+        std::sort(data + partition.GetBegin(chunk), data + partition.GetEnd(chunk), comp);
+    });
+    // На шаге width сливаются пары соседних отсортированных отрезков из width частей
+    for (size_t width = 1; width < chunk_count; width *= 2) {
+        const size_t merge_count = (chunk_count + 2 * width - 1) / (2 * width);
+        pool.Run(merge_count, [&](size_t merge) {
+            const size_t first = merge * 2 * width;
+            const size_t middle = std::min(first + width, chunk_count);
+            const size_t last = std::min(first + 2 * width, chunk_count);
+            std::inplace_merge(data + partition.GetBegin(first), data + partition.GetBegin(middle),
+                               data + partition.GetEnd(last - 1), comp);
+        });
+    }
+}
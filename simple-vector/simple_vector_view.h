@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "array_ptr.h"
+#include "comparison.h"
+#include "hardening.h"
+
+using namespace std::literals;
+
+// Определяет, хранит ли Container элементы непрерывно и можно ли обращаться
+// к ним через Type*: Data() возвращает указатель, а размер возвращает GetSize().
+// Таковы SimpleVector, SmallSimpleVector и MappedSimpleVector
+template <typename Container, typename Type, typename = void>
+struct IsContiguousContainerOf : std::false_type {
+};
+
+template <typename Container, typename Type>
+struct IsContiguousContainerOf<Container, Type,
+                               std::void_t<decltype(std::declval<Container&>().GetSize())>>
+    : std::bool_constant<std::is_pointer_v<decltype(std::declval<Container&>().Data())> &&
+                         std::is_convertible_v<decltype(std::declval<Container&>().Data()), Type*>> {
+};
+
+// Невладеющее представление непрерывного массива элементов: указатель и размер,
+// как std::span. SimpleVectorView<const Type> только читает элементы,
+// SimpleVectorView<Type> может их изменять. Представление не продлевает жизнь
+// массива и становится недействительным, когда владелец перевыделяет или
+// освобождает память. Функции, принимающие SimpleVectorView<const Type>,
+// принимают и векторы, и их части без копирования
+template <typename Type>
+class SimpleVectorView {
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+    using ValueType = std::remove_cv_t<Type>;
+
+    // Передаётся как count в Subview, чтобы взять все элементы до конца
+    static constexpr size_t kUntilEnd = static_cast<size_t>(-1);
+
+    SimpleVectorView() noexcept = default;
+
+    constexpr SimpleVectorView(Type* data, size_t size) noexcept
+        : data_(data)
+        , size_(size) {
+    }
+
+    // Представление первых size элементов массива ArrayPtr. Элементы должен создать владелец
+    template <typename Allocator>
+    constexpr SimpleVectorView(const ArrayPtr<ValueType, Allocator>& items, size_t size) noexcept
+        : data_(items.Get())
+        , size_(size) {
+        assert(size <= items.GetSize());
+    }
+
+    // Представление встроенного массива
+    template <size_t N>
+    constexpr SimpleVectorView(Type (&items)[N]) noexcept
+        : data_(items)
+        , size_(N) {
+    }
+
+    // Представление элементов SimpleVector и других контейнеров с непрерывным хранением
+    template <typename Container, std::enable_if_t<!std::is_same_v<std::decay_t<Container>, SimpleVectorView> &&
+                                                       IsContiguousContainerOf<Container, Type>::value,
+                                                   int> = 0>
+    constexpr SimpleVectorView(Container& container) noexcept
+        : data_(container.Data())
+        , size_(container.GetSize()) {
+    }
+
+    // Представление изменяемых элементов преобразуется в представление константных
+    template <typename T = Type, std::enable_if_t<std::is_const_v<T>, int> = 0>
+    constexpr SimpleVectorView(const SimpleVectorView<ValueType>& other) noexcept
+        : data_(other.Data())
+        , size_(other.GetSize()) {
+    }
+
+    constexpr Type* Data() const noexcept {
+        return data_;
+    }
+
+    constexpr size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    constexpr bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    constexpr Type& operator[](size_t index) const noexcept {
+        SIMPLE_VECTOR_CHECK(index < size_, "index out of range");
+        return data_[index];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    constexpr Type& At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("index out of range"s);
+        }
+        return data_[index];
+    }
+
+    // Возвращает представление count элементов, начиная с offset.
+    // Если до конца меньше count элементов, берутся все оставшиеся.
+    // Выбрасывает исключение std::out_of_range, если offset > size
+    constexpr SimpleVectorView Subview(size_t offset, size_t count = kUntilEnd) const {
+        if (offset > size_) {
+            throw std::out_of_range("subview offset out of range"s);
+        }
+        return SimpleVectorView(data_ + offset, std::min(count, size_ - offset));
+    }
+
+    // Возвращает представление первых count элементов. count не больше size
+    constexpr SimpleVectorView First(size_t count) const noexcept {
+        SIMPLE_VECTOR_CHECK(count <= size_, "First count out of range");
+        return SimpleVectorView(data_, count);
+    }
+
+    // Возвращает представление последних count элементов. count не больше size
+    constexpr SimpleVectorView Last(size_t count) const noexcept {
+        SIMPLE_VECTOR_CHECK(count <= size_, "Last count out of range");
+        return SimpleVectorView(data_ + (size_ - count), count);
+    }
+
+    constexpr Iterator begin() const noexcept {
+        return data_;
+    }
+
+    constexpr Iterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    constexpr ConstIterator cbegin() const noexcept {
+        return data_;
+    }
+
+    constexpr ConstIterator cend() const noexcept {
+        return data_ + size_;
+    }
+
+private:
+    Type* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+template <typename Type, typename Allocator>
+SimpleVectorView(const ArrayPtr<Type, Allocator>&, size_t) -> SimpleVectorView<Type>;
+
+template <typename Type, size_t N>
+SimpleVectorView(Type (&)[N]) -> SimpleVectorView<Type>;
+
+// Операторы сравнения сравнивают содержимое представлений, в том числе
+// представлений константных и изменяемых элементов, не копируя элементы
+template <typename Lhs, typename Rhs, std::enable_if_t<std::is_same_v<std::remove_cv_t<Lhs>, std::remove_cv_t<Rhs>>, int> = 0>
+SIMPLE_VECTOR_CONSTEXPR bool operator==(SimpleVectorView<Lhs> lhs, SimpleVectorView<Rhs> rhs) {
+    if (lhs.GetSize() != rhs.GetSize()) {
+        return false;
+    }
+    return lhs.Data() == rhs.Data() || RangesEqual<std::remove_cv_t<Lhs>>(lhs.Data(), rhs.Data(), lhs.GetSize());
+}
+
+template <typename Lhs, typename Rhs, std::enable_if_t<std::is_same_v<std::remove_cv_t<Lhs>, std::remove_cv_t<Rhs>>, int> = 0>
+SIMPLE_VECTOR_CONSTEXPR bool operator!=(SimpleVectorView<Lhs> lhs, SimpleVectorView<Rhs> rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Lhs, typename Rhs, std::enable_if_t<std::is_same_v<std::remove_cv_t<Lhs>, std::remove_cv_t<Rhs>>, int> = 0>
+SIMPLE_VECTOR_CONSTEXPR bool operator<(SimpleVectorView<Lhs> lhs, SimpleVectorView<Rhs> rhs) {
+    return RangesLess<std::remove_cv_t<Lhs>>(lhs.Data(), lhs.GetSize(), rhs.Data(), rhs.GetSize());
+}
+
+template <typename Lhs, typename Rhs, std::enable_if_t<std::is_same_v<std::remove_cv_t<Lhs>, std::remove_cv_t<Rhs>>, int> = 0>
+SIMPLE_VECTOR_CONSTEXPR bool operator<=(SimpleVectorView<Lhs> lhs, SimpleVectorView<Rhs> rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename Lhs, typename Rhs, std::enable_if_t<std::is_same_v<std::remove_cv_t<Lhs>, std::remove_cv_t<Rhs>>, int> = 0>
+SIMPLE_VECTOR_CONSTEXPR bool operator>(SimpleVectorView<Lhs> lhs, SimpleVectorView<Rhs> rhs) {
+    return rhs < lhs;
+}
+
+template <typename Lhs, typename Rhs, std::enable_if_t<std::is_same_v<std::remove_cv_t<Lhs>, std::remove_cv_t<Rhs>>, int> = 0>
+SIMPLE_VECTOR_CONSTEXPR bool operator>=(SimpleVectorView<Lhs> lhs, SimpleVectorView<Rhs> rhs) {
+    return !(lhs < rhs);
+}
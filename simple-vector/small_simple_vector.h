@@ -0,0 +1,460 @@
+#pragma once
+
+#include <cassert>
+#include <initializer_list>
+#include <stdexcept>
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "array_ptr.h"
+#include "growth_policy.h"
+#include "hardening.h"
+#include "relocation.h"
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+// Вектор с тем же интерфейсом, что и SimpleVector, хранящий до N элементов
+// прямо в объекте. Память в куче выделяется, только когда элементов становится
+// больше N; после этого вектор ведёт себя как обычный SimpleVector и растёт
+// по политике GrowthPolicy
+template <typename Type, size_t N, typename GrowthPolicy = DoublingGrowth>
+class SmallSimpleVector {
+    static_assert(N > 0, "inline capacity must be positive");
+
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+
+    SmallSimpleVector() noexcept = default;
+
+    // Создаёт вектор из size элементов, инициализированных значением по умолчанию
+    explicit SmallSimpleVector(size_t size) {
+        Reserve(size);
+        UninitializedValueConstructN(Alloc(), Data(), size);
+        size_ = size;
+    }
+
+    // Создаёт вектор из size элементов, инициализированных значением value
+    SmallSimpleVector(size_t size, const Type& value) {
+        Reserve(size);
+        UninitializedFillN(Alloc(), Data(), size, value);
+        size_ = size;
+    }
+
+    // Создаёт вектор из std::initializer_list
+    SmallSimpleVector(std::initializer_list<Type> init) {
+        Reserve(init.size());
+        UninitializedCopyN(Alloc(), init.begin(), init.size(), Data());
+        size_ = init.size();
+    }
+
+    SmallSimpleVector(const ReserveProxyObj& obj) {
+        Reserve(obj.GetCapacityToReserve());
+    }
+
+    SmallSimpleVector(const SmallSimpleVector& other) {
+        Reserve(other.size_);
+        UninitializedCopyN(Alloc(), other.begin(), other.size_, Data());
+        size_ = other.size_;
+    }
+
+    // Забирает память other, если его элементы в куче, иначе переносит элементы
+    // из встроенного буфера other в свой
+    SmallSimpleVector(SmallSimpleVector&& other) noexcept(std::is_nothrow_move_constructible_v<Type>) {
+        TakeContents(other);
+    }
+
+    ~SmallSimpleVector() {
+        DestroyN(Alloc(), Data(), size_);
+    }
+
+    SmallSimpleVector& operator=(const SmallSimpleVector& rhs) {
+        if (this != &rhs) {
+            SmallSimpleVector tmp(rhs);
+            *this = std::move(tmp);
+        }
+        return *this;
+    }
+
+    SmallSimpleVector& operator=(SmallSimpleVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<Type>) {
+        if (this != &rhs) {
+            Clear();
+            heap_ = ArrayPtr<Type>();
+            TakeContents(rhs);
+        }
+        return *this;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (GetCapacity() < new_capacity) {
+            Reallocate(new_capacity);
+        }
+    }
+
+    // Уменьшает вместимость до размера вектора. Если элементы помещаются
+    // во встроенный буфер, они возвращаются в него, а память в куче освобождается
+    void ShrinkToFit() {
+        ShrinkTo(size_);
+    }
+
+    // Уменьшает вместимость до new_capacity, но не меньше размера вектора и N
+    void ShrinkTo(size_t new_capacity) {
+        new_capacity = std::max(new_capacity, size_);
+        if (!IsOnHeap() || new_capacity >= GetCapacity()) {
+            return;
+        }
+        if (new_capacity <= N) {
+            RelocateN(Alloc(), heap_.Get(), size_, reinterpret_cast<Type*>(inline_items_));
+            heap_ = ArrayPtr<Type>();
+        } else {
+            Reallocate(new_capacity);
+        }
+    }
+
+    // Возвращает, сколько байт выделено под элементы (во встроенном буфере
+    // или в куче) и сколько из них занято
+    VectorMemoryUsage MemoryUsage() const noexcept {
+        return {GetCapacity() * sizeof(Type), size_ * sizeof(Type)};
+    }
+
+    // Обменивает значение с другим вектором
+    void swap(SmallSimpleVector& other) noexcept(std::is_nothrow_move_constructible_v<Type>) {
+        if (IsOnHeap() && other.IsOnHeap()) {
+            heap_.swap(other.heap_);
+            std::swap(size_, other.size_);
+            return;
+        }
+        SmallSimpleVector tmp(std::move(other));
+        other.TakeContents(*this);
+        TakeContents(tmp);
+    }
+
+    // Добавляет элемент в конец вектора
+    // При нехватке места увеличивает вместимость вектора по политике GrowthPolicy
+    void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    // Создаёт элемент в конце вектора непосредственно из аргументов args.
+    // Возвращает ссылку на созданный элемент
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        if (size_ == GetCapacity()) {
+            GrowAndEmplace(size_, std::forward<Args>(args)...);
+        } else {
+            Construct(Alloc(), end(), std::forward<Args>(args)...);
+            ++size_;
+        }
+        return Data()[size_ - 1];
+    }
+
+    // Вставляет значение value в позицию pos.
+    // Возвращает итератор на вставленное значение
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        return Emplace(pos, value);
+    }
+
+    Iterator Insert(ConstIterator pos, Type&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    // Создаёт элемент в позиции pos из аргументов args.
+    // Возвращает итератор на созданный элемент
+    template <typename... Args>
+    Iterator Emplace(ConstIterator pos, Args&&... args) {
+        SIMPLE_VECTOR_CHECK(pos >= cbegin() && pos <= cend(), "insert position out of range");
+        const size_t index = pos - cbegin();
+        if (size_ == GetCapacity()) {
+            GrowAndEmplace(index, std::forward<Args>(args)...);
+            return begin() + index;
+        }
+
+        auto it = begin() + index;
+        if (it == end()) {
+            Construct(Alloc(), it, std::forward<Args>(args)...);
+        } else {
+            Type value(std::forward<Args>(args)...);
+            OpenGap(Alloc(), it, end(), 1);
+            try {
+                Construct(Alloc(), it, std::move(value));
+            } catch (...) {
+                CloseGap(Alloc(), it, end() + 1, 1);
+                throw;
+            }
+        }
+        ++size_;
+        return it;
+    }
+
+    // Удаляет последний элемент вектора. Вектор не должен быть пустым
+    void PopBack() noexcept {
+        SIMPLE_VECTOR_CHECK(!IsEmpty(), "PopBack on empty vector");
+        --size_;
+        std::allocator_traits<std::allocator<Type>>::destroy(Alloc(), Data() + size_);
+        MaybeShrink();
+    }
+
+    // Удаляет элемент вектора в указанной позиции
+    Iterator Erase(ConstIterator pos) {
+        SIMPLE_VECTOR_CHECK(pos >= cbegin() && pos < cend(), "erase position out of range");
+        const size_t index = pos - cbegin();
+        EraseN(Alloc(), Data() + index, Data() + size_, 1);
+        --size_;
+        MaybeShrink();
+        return begin() + index;
+    }
+
+    // Удаляет элемент в позиции pos за O(1), перемещая на его место последний
+    // элемент. Порядок элементов не сохраняется
+    Iterator SwapRemove(ConstIterator pos) {
+        SIMPLE_VECTOR_CHECK(pos >= cbegin() && pos < cend(), "erase position out of range");
+        const size_t index = pos - cbegin();
+        Type* const last = Data() + size_ - 1;
+        if (Data() + index != last) {
+            Data()[index] = std::move(*last);
+        }
+        std::allocator_traits<std::allocator<Type>>::destroy(Alloc(), last);
+        --size_;
+        MaybeShrink();
+        return begin() + index;
+    }
+
+    // Удаляет элементы, для которых pred истинен, за один проход, сохраняя порядок
+    // остальных. Возвращает количество удалённых элементов
+    template <typename Predicate>
+    size_t EraseIf(Predicate pred) {
+        const size_t removed = static_cast<size_t>(end() - CompactIf(Alloc(), begin(), end(), pred));
+        if (removed != 0) {
+            size_ -= removed;
+            MaybeShrink();
+        }
+        return removed;
+    }
+
+    // Удаляет элементы с индексами indices, которые должны строго возрастать
+    void EraseIndices(SimpleVectorView<const size_t> indices) {
+        for (size_t k = 0; k < indices.GetSize(); ++k) {
+            SIMPLE_VECTOR_CHECK(indices[k] < size_ && (k == 0 || indices[k - 1] < indices[k]),
+                                "erase indices must be increasing and in range");
+        }
+        if (indices.IsEmpty()) {
+            return;
+        }
+        size_ = static_cast<size_t>(CompactIndices(Alloc(), Data(), size_, indices.Data(), indices.GetSize()) - Data());
+        MaybeShrink();
+    }
+
+    // Возвращает количество элементов в массиве
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    // Возвращает вместимость массива: N, пока элементы во встроенном буфере
+    size_t GetCapacity() const noexcept {
+        return IsOnHeap() ? heap_.GetSize() : N;
+    }
+
+    // Сообщает, пустой ли массив
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    // Сообщает, вынесены ли элементы в кучу
+    bool IsOnHeap() const noexcept {
+        return static_cast<bool>(heap_);
+    }
+
+    // Возвращает ссылку на элемент с индексом index
+    Type& operator[](size_t index) noexcept {
+        SIMPLE_VECTOR_CHECK(index < size_, "index out of range");
+        return Data()[index];
+    }
+
+    // Возвращает константную ссылку на элемент с индексом index
+    const Type& operator[](size_t index) const noexcept {
+        SIMPLE_VECTOR_CHECK(index < size_, "index out of range");
+        return Data()[index];
+    }
+
+    // Возвращает ссылку на элемент с индексом index
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("index out of range"s);
+        }
+        return Data()[index];
+    }
+
+    // Возвращает константную ссылку на элемент с индексом index
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    const Type& At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("index out of range"s);
+        }
+        return Data()[index];
+    }
+
+    // Разрушает элементы массива, не изменяя его вместимость
+    void Clear() noexcept {
+        DestroyN(Alloc(), Data(), size_);
+        size_ = 0;
+        MaybeShrink();
+    }
+
+    // Изменяет размер массива.
+    // При увеличении размера новые элементы получают значение по умолчанию для типа Type,
+    // при уменьшении лишние элементы разрушаются
+    void Resize(size_t new_size) {
+        if (new_size <= size_) {
+            DestroyN(Alloc(), begin() + new_size, size_ - new_size);
+            size_ = new_size;
+            MaybeShrink();
+            return;
+        }
+
+        if (new_size > GetCapacity()) {
+            Reallocate(NextCapacity(new_size));
+        }
+
+        UninitializedValueConstructN(Alloc(), end(), new_size - size_);
+        size_ = new_size;
+    }
+
+    // Возвращает указатель на первый элемент: во встроенном буфере или в куче
+    Type* Data() noexcept {
+        return IsOnHeap() ? heap_.Get() : reinterpret_cast<Type*>(inline_items_);
+    }
+
+    const Type* Data() const noexcept {
+        return IsOnHeap() ? heap_.Get() : reinterpret_cast<const Type*>(inline_items_);
+    }
+
+    Iterator begin() noexcept {
+        return Data();
+    }
+
+    Iterator end() noexcept {
+        return Data() + size_;
+    }
+
+    ConstIterator begin() const noexcept {
+        return Data();
+    }
+
+    ConstIterator end() const noexcept {
+        return Data() + size_;
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    // Пока heap_ пуст, элементы живут во встроенном буфере inline_items_
+    alignas(Type) unsigned char inline_items_[sizeof(Type) * N];
+    ArrayPtr<Type> heap_;
+    size_t size_ = 0;
+
+    std::allocator<Type>& Alloc() noexcept {
+        return heap_.GetAllocator();
+    }
+
+    // Переносит содержимое other в пустой вектор без памяти в куче.
+    // После переноса other пуст и хранит элементы во встроенном буфере
+    void TakeContents(SmallSimpleVector& other) {
+        assert(size_ == 0 && !IsOnHeap());
+        if (other.IsOnHeap()) {
+            heap_ = std::move(other.heap_);
+        } else {
+            RelocateN(Alloc(), other.Data(), other.size_, Data());
+        }
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    // Уменьшает вместимость после удаления элементов, если этого требует политика роста
+    void MaybeShrink() noexcept {
+        if constexpr (HasShrinkCapacity<GrowthPolicy>::value) {
+            if (IsOnHeap()) {
+                try {
+                    ShrinkTo(GrowthPolicy::ShrinkCapacity(size_, GetCapacity(), sizeof(Type)));
+                } catch (...) {
+                }
+            }
+        }
+    }
+
+    // Возвращает вместимость для роста до required элементов по политике GrowthPolicy
+    size_t NextCapacity(size_t required) const noexcept {
+        return GrowthPolicy::NextCapacity(GetCapacity(), required, sizeof(Type));
+    }
+
+    // Переносит элементы в кучу, в память вместимостью по политике роста,
+    // создав в ней элемент с индексом index из args
+    template <typename... Args>
+    void GrowAndEmplace(size_t index, Args&&... args) {
+        ArrayPtr<Type> new_items(NextCapacity(size_ + 1));
+        Type* new_begin = new_items.Get();
+        Construct(Alloc(), new_begin + index, std::forward<Args>(args)...);
+        try {
+            UninitializedRelocateN(Alloc(), begin(), index, new_begin);
+        } catch (...) {
+            std::allocator_traits<std::allocator<Type>>::destroy(Alloc(), new_begin + index);
+            throw;
+        }
+        try {
+            UninitializedRelocateN(Alloc(), begin() + index, size_ - index, new_begin + index + 1);
+        } catch (...) {
+            DestroyN(Alloc(), new_begin, index + 1);
+            throw;
+        }
+        DestroyRelocatedN(Alloc(), Data(), size_);
+        heap_ = std::move(new_items);
+        ++size_;
+    }
+
+    // Переносит элементы в кучу, в память вместимостью new_capacity
+    void Reallocate(size_t new_capacity) {
+        ArrayPtr<Type> new_items(new_capacity);
+        RelocateN(Alloc(), Data(), size_, new_items.Get());
+        heap_ = std::move(new_items);
+    }
+};
+
+template <typename Type, size_t N, typename GrowthPolicy>
+inline bool operator==(const SmallSimpleVector<Type, N, GrowthPolicy>& lhs, const SmallSimpleVector<Type, N, GrowthPolicy>& rhs) {
+    return SimpleVectorView<const Type>(lhs) == SimpleVectorView<const Type>(rhs);
+}
+
+template <typename Type, size_t N, typename GrowthPolicy>
+inline bool operator!=(const SmallSimpleVector<Type, N, GrowthPolicy>& lhs, const SmallSimpleVector<Type, N, GrowthPolicy>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type, size_t N, typename GrowthPolicy>
+inline bool operator<(const SmallSimpleVector<Type, N, GrowthPolicy>& lhs, const SmallSimpleVector<Type, N, GrowthPolicy>& rhs) {
+    return SimpleVectorView<const Type>(lhs) < SimpleVectorView<const Type>(rhs);
+}
+
+template <typename Type, size_t N, typename GrowthPolicy>
+inline bool operator<=(const SmallSimpleVector<Type, N, GrowthPolicy>& lhs, const SmallSimpleVector<Type, N, GrowthPolicy>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename Type, size_t N, typename GrowthPolicy>
+inline bool operator>(const SmallSimpleVector<Type, N, GrowthPolicy>& lhs, const SmallSimpleVector<Type, N, GrowthPolicy>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Type, size_t N, typename GrowthPolicy>
+inline bool operator>=(const SmallSimpleVector<Type, N, GrowthPolicy>& lhs, const SmallSimpleVector<Type, N, GrowthPolicy>& rhs) {
+    return rhs <= lhs;
+}
@@ -0,0 +1,413 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "array_ptr.h"
+#include "growth_policy.h"
+#include "relocation.h"
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+#include "uninitialized.h"
+
+using namespace std::literals;
+
+// Вектор записей из полей Fields..., хранящий каждое поле в отдельном непрерывном
+// столбце (structure of arrays). Проход по одному-двум полям читает только их
+// столбцы, а не записи целиком, и не тратит пропускную способность кэша на
+// остальные поля. Все столбцы имеют общие размер и вместимость, которую
+// определяет политика роста GrowthPolicy (см. growth_policy.h) по размеру записи.
+// operator[] возвращает кортеж ссылок на поля записи, а Column<I>() —
+// представление столбца I с begin и end. Итератора по записям нет: обходить
+// удобнее нужные столбцы
+template <typename GrowthPolicy, typename... Fields>
+class BasicSoAVector {
+    static_assert(sizeof...(Fields) > 0, "SoAVector needs at least one field");
+
+    using Columns = std::tuple<ArrayPtr<Fields>...>;
+
+public:
+    // Значение записи
+    using Row = std::tuple<Fields...>;
+    // Ссылки на поля записи: через них можно читать и присваивать поля,
+    // в том числе все сразу присваиванием кортежа
+    using Reference = std::tuple<Fields&...>;
+    using ConstReference = std::tuple<const Fields&...>;
+
+    template <size_t I>
+    using FieldType = std::tuple_element_t<I, Row>;
+
+    static constexpr size_t kColumnCount = sizeof...(Fields);
+    // Сколько байт занимает одна запись во всех столбцах
+    static constexpr size_t kRowSize = (sizeof(Fields) + ...);
+
+    BasicSoAVector() noexcept = default;
+
+    // Создаёт вектор из size записей, поля которых инициализированы значением по умолчанию
+    explicit BasicSoAVector(size_t size) {
+        Resize(size);
+    }
+
+    BasicSoAVector(const BasicSoAVector& other)
+        : columns_(AllocateColumns(other.size_))
+        , capacity_(other.size_) {
+        ConstructColumns(columns_, 0, other.size_, [&other](auto column, auto& alloc, auto* dest) {
+            UninitializedCopyN(alloc, std::get<decltype(column)::value>(other.columns_).Get(), other.size_, dest);
+        });
+        size_ = other.size_;
+    }
+
+    BasicSoAVector(BasicSoAVector&& other) noexcept
+        : columns_(std::move(other.columns_))
+        , size_(std::exchange(other.size_, 0))
+        , capacity_(std::exchange(other.capacity_, 0)) {
+    }
+
+    BasicSoAVector& operator=(const BasicSoAVector& rhs) {
+        if (this != &rhs) {
+            BasicSoAVector copy(rhs);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    BasicSoAVector& operator=(BasicSoAVector&& rhs) noexcept {
+        if (this != &rhs) {
+            DestroyColumns(0, size_);
+            columns_ = std::move(rhs.columns_);
+            size_ = std::exchange(rhs.size_, 0);
+            capacity_ = std::exchange(rhs.capacity_, 0);
+        }
+        return *this;
+    }
+
+    ~BasicSoAVector() {
+        DestroyColumns(0, size_);
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    size_t GetCapacity() const noexcept {
+        return capacity_;
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    // Возвращает ссылки на поля записи с индексом index
+    Reference operator[](size_t index) noexcept {
+        SIMPLE_VECTOR_CHECK(index < size_, "index out of range");
+        return RowAt<Reference>(columns_, index, std::index_sequence_for<Fields...>{});
+    }
+
+    ConstReference operator[](size_t index) const noexcept {
+        SIMPLE_VECTOR_CHECK(index < size_, "index out of range");
+        return RowAt<ConstReference>(columns_, index, std::index_sequence_for<Fields...>{});
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Reference At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("index out of range"s);
+        }
+        return (*this)[index];
+    }
+
+    ConstReference At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("index out of range"s);
+        }
+        return (*this)[index];
+    }
+
+    // Возвращает представление столбца поля I
+    template <size_t I>
+    SimpleVectorView<FieldType<I>> Column() noexcept {
+        return SimpleVectorView<FieldType<I>>(std::get<I>(columns_).Get(), size_);
+    }
+
+    template <size_t I>
+    SimpleVectorView<const FieldType<I>> Column() const noexcept {
+        return SimpleVectorView<const FieldType<I>>(std::get<I>(columns_).Get(), size_);
+    }
+
+    // Возвращает указатель на первый элемент столбца поля I
+    template <size_t I>
+    FieldType<I>* ColumnData() noexcept {
+        return std::get<I>(columns_).Get();
+    }
+
+    template <size_t I>
+    const FieldType<I>* ColumnData() const noexcept {
+        return std::get<I>(columns_).Get();
+    }
+
+    void PushBack(const Row& row) {
+        std::apply([this](const Fields&... fields) { EmplaceBack(fields...); }, row);
+    }
+
+    void PushBack(Row&& row) {
+        std::apply([this](Fields&... fields) { EmplaceBack(std::move(fields)...); }, row);
+    }
+
+    // Добавляет запись, создавая поле I из args[I]. Поля создаются в новой памяти
+    // до переноса остальных записей, поэтому args могут ссылаться на поля самого вектора
+    template <typename... Args>
+    Reference EmplaceBack(Args&&... args) {
+        static_assert(sizeof...(Args) == kColumnCount, "EmplaceBack takes one value per field");
+        auto values = std::forward_as_tuple(std::forward<Args>(args)...);
+        const auto construct = [&values](auto column, auto& alloc, auto* dest) {
+            Construct(alloc, dest, std::get<decltype(column)::value>(std::move(values)));
+        };
+        if (size_ == capacity_) {
+            const size_t new_capacity = NextCapacity(size_ + 1);
+            Columns new_columns = AllocateColumns(new_capacity);
+            ConstructColumns(new_columns, size_, 1, construct);
+            try {
+                RelocateColumns(new_columns);
+            } catch (...) {
+                DestroyColumns(new_columns, size_, 1);
+                throw;
+            }
+            columns_ = std::move(new_columns);
+            capacity_ = new_capacity;
+        } else {
+            ConstructColumns(columns_, size_, 1, construct);
+        }
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    // Удаляет последнюю запись. Вектор не должен быть пустым
+    void PopBack() noexcept {
+        SIMPLE_VECTOR_CHECK(!IsEmpty(), "PopBack on empty vector");
+        --size_;
+        DestroyColumns(size_, 1);
+        MaybeShrink();
+    }
+
+    // Удаляет запись с индексом index, сдвигая последующие во всех столбцах
+    void Erase(size_t index) {
+        Erase(index, index + 1);
+    }
+
+    // Удаляет записи с индексами [first, last), сдвигая хвост каждого столбца один раз.
+    // Сначала присваиванием сдвигаются столбцы с нетривиальным переносом, и только
+    // потом, без исключений, сдвигаются побайтово остальные и разрушаются поля за
+    // новым концом. Если присваивание бросит исключение, все поля остаются созданными
+    // и размер не меняется, но записи могут оказаться частично сдвинутыми
+    void Erase(size_t first, size_t last) {
+        SIMPLE_VECTOR_CHECK(first <= last && last <= size_, "erase range out of range");
+        const size_t count = last - first;
+        if (count == 0) {
+            return;
+        }
+        ForEachColumn(columns_, [&](auto& column) {
+            using Field = std::remove_pointer_t<decltype(column.Get())>;
+            if constexpr (!IsTriviallyRelocatableV<Field>) {
+                std::move(column.Get() + last, column.Get() + size_, column.Get() + first);
+            }
+        });
+        ForEachColumn(columns_, [&](auto& column) {
+            using Field = std::remove_pointer_t<decltype(column.Get())>;
+            if constexpr (IsTriviallyRelocatableV<Field>) {
+                EraseN(column.GetAllocator(), column.Get() + first, column.Get() + size_, count);
+            } else {
+                DestroyN(column.GetAllocator(), column.Get() + size_ - count, count);
+            }
+        });
+        size_ -= count;
+        MaybeShrink();
+    }
+
+    // Разрушает записи, не изменяя вместимость
+    // (если политика роста не освобождает память при удалении элементов)
+    void Clear() noexcept {
+        DestroyColumns(0, size_);
+        size_ = 0;
+        MaybeShrink();
+    }
+
+    // Изменяет количество записей. Новые поля получают значение по умолчанию,
+    // лишние записи разрушаются
+    void Resize(size_t new_size) {
+        if (new_size <= size_) {
+            DestroyColumns(new_size, size_ - new_size);
+            size_ = new_size;
+            MaybeShrink();
+            return;
+        }
+        if (new_size > capacity_) {
+            Reallocate(NextCapacity(new_size));
+        }
+        ConstructColumns(columns_, size_, new_size - size_, [count = new_size - size_](auto, auto& alloc, auto* dest) {
+            UninitializedValueConstructN(alloc, dest, count);
+        });
+        size_ = new_size;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (capacity_ < new_capacity) {
+            Reallocate(new_capacity);
+        }
+    }
+
+    // Уменьшает вместимость всех столбцов до размера вектора
+    void ShrinkToFit() {
+        if (size_ < capacity_) {
+            Reallocate(size_);
+        }
+    }
+
+    // Возвращает, сколько байт выделено под столбцы и сколько из них занято
+    VectorMemoryUsage MemoryUsage() const noexcept {
+        return {capacity_ * kRowSize, size_ * kRowSize};
+    }
+
+    void swap(BasicSoAVector& other) noexcept {
+        ForEachColumnPair(columns_, other.columns_, [](auto& lhs, auto& rhs) {
+            lhs.swap(rhs);
+        });
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+private:
+    Columns columns_;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+
+    template <typename Tuple, typename Fn>
+    static void ForEachColumn(Tuple& columns, Fn&& fn) {
+        std::apply([&fn](auto&... column) { (fn(column), ...); }, columns);
+    }
+
+    template <typename Fn>
+    static void ForEachColumnPair(Columns& lhs, Columns& rhs, Fn&& fn) {
+        ForEachColumnPairImpl(lhs, rhs, fn, std::index_sequence_for<Fields...>{});
+    }
+
+    template <typename Fn, size_t... I>
+    static void ForEachColumnPairImpl(Columns& lhs, Columns& rhs, Fn& fn, std::index_sequence<I...>) {
+        (fn(std::get<I>(lhs), std::get<I>(rhs)), ...);
+    }
+
+    template <typename Result, typename Tuple, size_t... I>
+    static Result RowAt(Tuple& columns, size_t index, std::index_sequence<I...>) noexcept {
+        return Result(std::get<I>(columns)[index]...);
+    }
+
+    static Columns AllocateColumns(size_t capacity) {
+        return Columns(ArrayPtr<Fields>(capacity)...);
+    }
+
+    static size_t GetMaxSize() noexcept {
+        return std::min({std::allocator_traits<std::allocator<Fields>>::max_size(std::allocator<Fields>())...});
+    }
+
+    size_t NextCapacity(size_t required) const {
+        const size_t max_size = GetMaxSize();
+        if (required > max_size) {
+            throw std::length_error("SoAVector is too long"s);
+        }
+        return std::min(GrowthPolicy::NextCapacity(capacity_, required, kRowSize), max_size);
+    }
+
+    // Уменьшает вместимость после удаления записей, если этого требует политика
+    // роста. Ошибка перевыделения игнорируется: прерванный перенос оставляет
+    // записи на месте
+    void MaybeShrink() noexcept {
+        if constexpr (HasShrinkCapacity<GrowthPolicy>::value) {
+            const size_t new_capacity = GrowthPolicy::ShrinkCapacity(size_, capacity_, kRowSize);
+            if (new_capacity < capacity_) {
+                try {
+                    Reallocate(std::max(new_capacity, size_));
+                } catch (...) {
+                }
+            }
+        }
+    }
+
+    // Создаёт в каждом столбце target элементы [first, first + count) вызовом
+    // construct(column, alloc, dest), где column — std::integral_constant с номером
+    // столбца. construct сам разрушает созданное им при исключении, а элементы,
+    // уже созданные в предыдущих столбцах, разрушаются здесь
+    template <size_t I = 0, typename ConstructFn>
+    static void ConstructColumns(Columns& target, size_t first, size_t count, const ConstructFn& construct) {
+        if constexpr (I < kColumnCount) {
+            auto& column = std::get<I>(target);
+            construct(std::integral_constant<size_t, I>{}, column.GetAllocator(), column.Get() + first);
+            try {
+                ConstructColumns<I + 1>(target, first, count, construct);
+            } catch (...) {
+                DestroyN(column.GetAllocator(), column.Get() + first, count);
+                throw;
+            }
+        }
+    }
+
+    static void DestroyColumns(Columns& target, size_t first, size_t count) noexcept {
+        ForEachColumn(target, [first, count](auto& column) {
+            DestroyN(column.GetAllocator(), column.Get() + first, count);
+        });
+    }
+
+    void DestroyColumns(size_t first, size_t count) noexcept {
+        DestroyColumns(columns_, first, count);
+    }
+
+    // Переносит записи в столбцы target. Сначала переносятся столбцы, поля которых
+    // копируются: если копирование бросит исключение, ни одно поле ещё не перемещено,
+    // и записи остаются прежними, как при SimpleVector::Reserve. Остальные столбцы
+    // переносятся перемещением без исключений или побайтово. Шаг Step переносит
+    // столбец Step % kColumnCount в первом или втором проходе. Исходные объекты
+    // разрушаются только после того, как перенесены все столбцы
+    template <size_t Step = 0>
+    void RelocateColumns(Columns& target) {
+        if constexpr (Step < 2 * kColumnCount) {
+            constexpr size_t kColumn = Step % kColumnCount;
+            using Field = FieldType<kColumn>;
+            constexpr bool kCopied = !IsTriviallyRelocatableV<Field> && !IsRelocatedByMoveV<Field>;
+            if constexpr (kCopied != (Step < kColumnCount)) {
+                RelocateColumns<Step + 1>(target);
+            } else {
+                auto& source = std::get<kColumn>(columns_);
+                auto& dest = std::get<kColumn>(target);
+                UninitializedRelocateN(source.GetAllocator(), source.Get(), size_, dest.Get());
+                try {
+                    RelocateColumns<Step + 1>(target);
+                } catch (...) {
+                    DestroyRelocatedN(dest.GetAllocator(), dest.Get(), size_);
+                    throw;
+                }
+                DestroyRelocatedN(source.GetAllocator(), source.Get(), size_);
+            }
+        }
+    }
+
+    void Reallocate(size_t new_capacity) {
+        Columns new_columns = AllocateColumns(new_capacity);
+        RelocateColumns(new_columns);
+        columns_ = std::move(new_columns);
+        capacity_ = new_capacity;
+    }
+};
+
+// Структура массивов с удвоением вместимости. Другую политику роста задаёт
+// BasicSoAVector<GrowthPolicy, Fields...>
+template <typename... Fields>
+using SoAVector = BasicSoAVector<DoublingGrowth, Fields...>;
+
+template <typename GrowthPolicy, typename... Fields>
+void swap(BasicSoAVector<GrowthPolicy, Fields...>& lhs, BasicSoAVector<GrowthPolicy, Fields...>& rhs) noexcept {
+    lhs.swap(rhs);
+}
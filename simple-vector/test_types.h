@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+// Некопируемый тип, который можно только перемещать
+class X {
+public:
+    X()
+        : X(5) {
+    }
+    X(size_t num)
+        : x_(num) {
+    }
+    X(const X& other) = delete;
+    X& operator=(const X& other) = delete;
+    X(X&& other) {
+        x_ = std::exchange(other.x_, 0);
+    }
+    X& operator=(X&& other) {
+        x_ = std::exchange(other.x_, 0);
+        return *this;
+    }
+    size_t GetX() const {
+        return x_;
+    }
+
+private:
+    size_t x_;
+};
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Пул потоков фиксированного размера для параллельных алгоритмов над векторами
+// (simple_vector_algorithms.h). Пул выполняет пакет из task_count задач: каждая
+// получает свой номер, а вызывающий поток выполняет задачи вместе с рабочими
+// и ждёт завершения всего пакета. Пул без рабочих потоков выполняет задачи
+// в вызывающем потоке
+class ThreadPool {
+public:
+    // Создаёт пул с worker_count рабочими потоками
+    explicit ThreadPool(size_t worker_count) {
+        workers_.reserve(worker_count);
+        try {
+            for (size_t i = 0; i < worker_count; ++i) {
+                workers_.emplace_back([this] {
+                    WorkerLoop();
+                });
+            }
+        } catch (...) {
+            Stop();
+            throw;
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        Stop();
+    }
+
+    // Возвращает число потоков, выполняющих пакет, вместе с вызывающим
+    size_t GetThreadCount() const noexcept {
+        return workers_.size() + 1;
+    }
+
+    // Выполняет task(i) для каждого i из [0, task_count) и ждёт завершения всех задач.
+    // Если задачи выбросили исключения, после завершения пакета выбрасывается первое из них.
+    // Пакеты из разных потоков выполняются по очереди; вызывать Run из задачи нельзя
+    template <typename Task>
+    void Run(size_t task_count, Task task) {
+        if (task_count == 0) {
+            return;
+        }
+        if (workers_.empty() || task_count == 1) {
+            for (size_t i = 0; i < task_count; ++i) {
+                task(i);
+            }
+            return;
+        }
+
+        std::lock_guard run_guard(run_mutex_);
+        {
+            std::lock_guard guard(mutex_);
+            task_ = std::ref(task);
+            next_task_ = 0;
+            task_count_ = task_count;
+            finished_count_ = 0;
+            error_ = nullptr;
+            ++generation_;
+        }
+        wake_.notify_all();
+        ExecuteTasks();
+
+        std::unique_lock lock(mutex_);
+        done_.wait(lock, [this] {
+            return finished_count_ == task_count_;
+        });
+        task_ = nullptr;
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    std::mutex run_mutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::function<void(size_t)> task_;
+    size_t next_task_ = 0;
+    size_t task_count_ = 0;
+    size_t finished_count_ = 0;
+    size_t generation_ = 0;
+    std::exception_ptr error_;
+    bool stopping_ = false;
+
+    void WorkerLoop() {
+        size_t seen_generation = 0;
+        while (true) {
+            {
+                std::unique_lock lock(mutex_);
+                wake_.wait(lock, [this, seen_generation] {
+                    return stopping_ || generation_ != seen_generation;
+                });
+                if (stopping_) {
+                    return;
+                }
+                seen_generation = generation_;
+            }
+            ExecuteTasks();
+        }
+    }
+
+    // Берёт задачи текущего пакета, пока они не закончатся
+    void ExecuteTasks() {
+        std::unique_lock lock(mutex_);
+        while (next_task_ < task_count_) {
+            const size_t index = next_task_++;
+            lock.unlock();
+            std::exception_ptr error;
+            try {
+                task_(index);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            lock.lock();
+            if (error && !error_) {
+                error_ = error;
+            }
+            if (++finished_count_ == task_count_) {
+                done_.notify_all();
+            }
+        }
+    }
+
+    void Stop() noexcept {
+        {
+            std::lock_guard guard(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+};
+
+// Общий пул, рабочих потоков в котором на один меньше, чем аппаратных:
+// последним потоком служит вызывающий
+inline ThreadPool& DefaultThreadPool() {
+    static ThreadPool pool(std::max<size_t>(std::thread::hardware_concurrency(), 1) - 1);
+    return pool;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "constexpr_support.h"
+
+// Алгоритмы над неинициализированной памятью, создающие и разрушающие объекты
+// через std::allocator_traits, как это делают стандартные контейнеры.
+// Для std::allocator используются стандартные алгоритмы — у них есть
+// оптимизации для тривиальных типов (memset, memmove).
+// Во время компиляции (C++20) объекты создаются по одному через allocator_traits
+
+template <typename Allocator, typename Type>
+inline constexpr bool IsStdAllocatorV = std::is_same_v<Allocator, std::allocator<Type>>;
+
+// Определяет, задаёт ли аллокатор собственный construct для копирования Type
+template <typename Allocator, typename Type, typename = void>
+struct HasCopyConstruct : std::false_type {
+};
+
+template <typename Allocator, typename Type>
+struct HasCopyConstruct<Allocator, Type, std::void_t<decltype(std::declval<Allocator&>().construct(
+                                             std::declval<Type*>(), std::declval<const Type&>()))>>
+    : std::true_type {
+};
+
+// Копию можно создать побайтовым копированием, если тип тривиально копируем,
+// а аллокатор не вмешивается в создание объектов (std::allocator объявляет
+// construct, но он лишь вызывает конструктор)
+template <typename Allocator, typename Type>
+inline constexpr bool IsBitwiseCopyConstructibleV =
+    std::is_trivially_copyable_v<Type> && (IsStdAllocatorV<Allocator, Type> || !HasCopyConstruct<Allocator, Type>::value);
+
+// Создаёт объект по адресу ptr из аргументов args
+template <typename Allocator, typename Type, typename... Args>
+SIMPLE_VECTOR_CONSTEXPR void Construct(Allocator& alloc, Type* ptr, Args&&... args) {
+    std::allocator_traits<Allocator>::construct(alloc, ptr, std::forward<Args>(args)...);
+}
+
+// Разрушает count объектов, начиная с first
+template <typename Allocator, typename Type>
+SIMPLE_VECTOR_CONSTEXPR void DestroyN(Allocator& alloc, Type* first, size_t count) noexcept {
+    if constexpr (IsStdAllocatorV<Allocator, Type>) {
+        std::destroy_n(first, count);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            std::allocator_traits<Allocator>::destroy(alloc, first + i);
+        }
+    }
+}
+
+// Создаёт count объектов, начиная с dest, вызывая construct_one(alloc, ptr) для каждого.
+// Если создание очередного объекта бросает исключение, уже созданные разрушаются
+template <typename Allocator, typename Type, typename ConstructOne>
+SIMPLE_VECTOR_CONSTEXPR void UninitializedConstructN(Allocator& alloc, Type* dest, size_t count, ConstructOne construct_one) {
+    size_t constructed = 0;
+    try {
+        for (; constructed < count; ++constructed) {
+            construct_one(alloc, dest + constructed);
+        }
+    } catch (...) {
+        DestroyN(alloc, dest, constructed);
+        throw;
+    }
+}
+
+// Создаёт count объектов со значением по умолчанию
+template <typename Allocator, typename Type>
+SIMPLE_VECTOR_CONSTEXPR void UninitializedValueConstructN(Allocator& alloc, Type* dest, size_t count) {
+    if constexpr (IsStdAllocatorV<Allocator, Type>) {
+        if (!IsConstantEvaluated()) {
+            std::uninitialized_value_construct_n(dest, count);
+            return;
+        }
+    }
+    UninitializedConstructN(alloc, dest, count, [](Allocator& a, Type* ptr) {
+        Construct(a, ptr);
+    });
+}
+
+// Создаёт count копий value
+template <typename Allocator, typename Type>
+SIMPLE_VECTOR_CONSTEXPR void UninitializedFillN(Allocator& alloc, Type* dest, size_t count, const Type& value) {
+    if constexpr (IsStdAllocatorV<Allocator, Type>) {
+        if (!IsConstantEvaluated()) {
+            std::uninitialized_fill_n(dest, count, value);
+            return;
+        }
+    }
+    UninitializedConstructN(alloc, dest, count, [&value](Allocator& a, Type* ptr) {
+        Construct(a, ptr, value);
+    });
+}
+
+// Создаёт count объектов из элементов, начиная с first.
+// С std::move_iterator элементы перемещаются.
+// Копии непрерывного массива тривиально копируемых элементов создаются одним memcpy
+template <typename Allocator, typename InputIt, typename Type>
+SIMPLE_VECTOR_CONSTEXPR void UninitializedCopyN(Allocator& alloc, InputIt first, size_t count, Type* dest) {
+    if constexpr (std::is_pointer_v<InputIt> && IsBitwiseCopyConstructibleV<Allocator, Type> &&
+                  std::is_same_v<std::remove_cv_t<std::remove_pointer_t<InputIt>>, Type>) {
+        if (!IsConstantEvaluated()) {
+            if (count != 0) {
+                std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), count * sizeof(Type));
+            }
+            return;
+        }
+    } else if constexpr (IsStdAllocatorV<Allocator, Type>) {
+        if (!IsConstantEvaluated()) {
+            std::uninitialized_copy_n(first, count, dest);
+            return;
+        }
+    }
+    UninitializedConstructN(alloc, dest, count, [&first](Allocator& a, Type* ptr) {
+        Construct(a, ptr, *first);
+        ++first;
+    });
+}
+
+// Перемещает count объектов, начиная с first, в неинициализированную память dest
+template <typename Allocator, typename Type>
+SIMPLE_VECTOR_CONSTEXPR void UninitializedMoveN(Allocator& alloc, Type* first, size_t count, Type* dest) {
+    UninitializedCopyN(alloc, std::make_move_iterator(first), count, dest);
+}